@@ -124,6 +124,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaseprimaryvariables.hh
              opm/models/discretization/ecfv/ecfvgridcommhandlefactory.hh
              opm/models/discretization/ecfv/ecfvstencil.hh
+             opm/models/discretization/ecfv/ecfvstencilcache.hh
              opm/models/discretization/ecfv/ecfvbaseoutputmodule.hh
              opm/models/discretization/ecfv/ecfvdiscretization.hh
              opm/models/discretization/ecfv/ecfvproperties.hh
@@ -186,6 +187,8 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/parallel/gridcommhandles.hh
              opm/models/parallel/mpibuffer.hh
              opm/models/parallel/threadedentityiterator.hh
+             opm/models/parallel/elementcoloring.hh
+             opm/models/parallel/atomicbitvector.hh
              opm/models/pvs/pvsboundaryratevector.hh
              opm/models/pvs/pvsratevector.hh
              opm/models/pvs/pvsindices.hh
@@ -208,6 +211,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/richards/richardslocalresidual.hh
              opm/models/utils/start.hh
              opm/models/utils/timerguard.hh
+             opm/models/utils/timestepcontrol.hh
              opm/models/utils/propertysystem.hh
              opm/models/utils/pffgridvector.hh
              opm/models/utils/prefetch.hh
@@ -224,6 +228,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/vertexborderlistfromgrid.hh
              opm/simulators/linalg/linearsolverreport.hh
              opm/simulators/linalg/istlsparsematrixadapter.hh
+             opm/simulators/linalg/sparsitypattern.hh
              opm/simulators/linalg/istlpreconditionerwrappers.hh
              opm/simulators/linalg/residreductioncriterion.hh
              opm/simulators/linalg/overlappingbcrsmatrix.hh
@@ -236,6 +241,8 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/elementborderlistfromgrid.hh
              opm/simulators/linalg/combinedcriterion.hh
              opm/simulators/linalg/bicgstabsolver.hh
+             opm/simulators/linalg/blockilu0preconditioner.hh
+             opm/simulators/linalg/krylovkernels.hh
              opm/simulators/linalg/globalindices.hh
              opm/simulators/linalg/superlubackend.hh
              opm/simulators/linalg/matrixblock.hh
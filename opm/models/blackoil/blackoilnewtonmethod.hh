@@ -34,6 +34,8 @@
 
 #include <opm/material/common/Unused.hpp>
 
+#include <vector>
+
 BEGIN_PROPERTIES
 
 NEW_PROP_TAG(DpMaxRel);
@@ -65,6 +67,7 @@ class BlackOilNewtonMethod : public GET_PROP_TYPE(TypeTag, DiscNewtonMethod)
     typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Linearizer) Linearizer;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
 
     static const unsigned numEq = GET_PROP_VALUE(TypeTag, NumEq);
 
@@ -84,7 +87,7 @@ public:
         ParentType::finishInit();
 
         wasSwitched_.resize(this->model().numTotalDof());
-        std::fill(wasSwitched_.begin(), wasSwitched_.end(), false);
+        std::fill(wasSwitched_.begin(), wasSwitched_.end(), 0);
     }
 
     /*!
@@ -117,6 +120,7 @@ protected:
     void beginIteration_()
     {
         numPriVarsSwitched_ = 0;
+        threadNumPriVarsSwitched_.assign(ThreadManager::maxThreads(), 0);
         ParentType::beginIteration_();
     }
 
@@ -159,6 +163,13 @@ public:
                                 solutionUpdate,
                                 currentResidual);
             succeeded = 1;
+
+            // the DOFs may have been updated by multiple threads, each of which counts
+            // the switched DOFs separately
+            for (auto& threadSwitched : threadNumPriVarsSwitched_) {
+                numPriVarsSwitched_ += threadSwitched;
+                threadSwitched = 0;
+            }
         }
         catch (...) {
             std::cout << "Newton update threw an exception on rank "
@@ -303,21 +314,23 @@ protected:
             wasSwitched_[globalDofIdx] = nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx);
 
         if (wasSwitched_[globalDofIdx])
-            ++ numPriVarsSwitched_;
+            ++ threadNumPriVarsSwitched_[ThreadManager::threadId()];
 
         nextValue.checkDefined();
     }
 
 private:
     int numPriVarsSwitched_;
+    std::vector<int> threadNumPriVarsSwitched_;
 
     Scalar priVarOscilationThreshold_;
     Scalar dpMaxRel_;
     Scalar dsMax_;
 
     // keep track of cells where the primary variable meaning has changed
-    // to detect and hinder oscillations
-    std::vector<bool> wasSwitched_;
+    // to detect and hinder oscillations. a bool vector cannot be used here because the
+    // entries are written concurrently by multiple threads.
+    std::vector<unsigned char> wasSwitched_;
 };
 } // namespace Opm
 
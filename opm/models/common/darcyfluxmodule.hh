@@ -218,29 +218,51 @@ protected:
             Opm::Valgrind::CheckDefined(potentialGrad_[phaseIdx]);
         }
 
-        // correct the pressure gradients by the gravitational acceleration
-        if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity)) {
-            // estimate the gravitational acceleration at a given SCV face
-            // using the arithmetic mean
-            const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
-            const auto& gEx = elemCtx.problem().gravity(elemCtx, j, timeIdx);
+        // the quantities of the face which do not depend on the solution. if the
+        // problem caches them, they are only computed once.
+        const auto& problem = elemCtx.problem();
+        const auto* cachedQuantities =
+            problem.enableIntersectionQuantityCache()
+            ? &problem.intersectionQuantities(elemCtx, faceIdx, timeIdx)
+            : nullptr;
 
+        // correct the pressure gradients by the gravitational acceleration
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, EnableGravity)) {
             const auto& intQuantsIn = elemCtx.intensiveQuantities(i, timeIdx);
             const auto& intQuantsEx = elemCtx.intensiveQuantities(j, timeIdx);
 
-            const auto& posIn = elemCtx.pos(i, timeIdx);
-            const auto& posEx = elemCtx.pos(j, timeIdx);
-            const auto& posFace = scvf.integrationPos();
-
-            // the distance between the centers of the control volumes
-            DimVector distVecIn(posIn);
-            DimVector distVecEx(posEx);
-            DimVector distVecTotal(posEx);
-
-            distVecIn -= posFace;
-            distVecEx -= posFace;
-            distVecTotal -= posIn;
-            Scalar absDistTotalSquared = distVecTotal.two_norm2();
+            // the distance between the centers of the control volumes and the
+            // gravitational acceleration times the distances between the centers of the
+            // control volumes and the integration point of the face
+            DimVector distVecTotal;
+            Scalar absDistTotalSquared;
+            Scalar gravityDistIn;
+            Scalar gravityDistEx;
+            if (cachedQuantities) {
+                distVecTotal = cachedQuantities->distVecTotal;
+                absDistTotalSquared = cachedQuantities->absDistTotalSquared;
+                gravityDistIn = cachedQuantities->gravityDistIn;
+                gravityDistEx = cachedQuantities->gravityDistEx;
+            }
+            else {
+                const auto& gIn = problem.gravity(elemCtx, i, timeIdx);
+                const auto& gEx = problem.gravity(elemCtx, j, timeIdx);
+
+                const auto& posIn = elemCtx.pos(i, timeIdx);
+                const auto& posEx = elemCtx.pos(j, timeIdx);
+                const auto& posFace = scvf.integrationPos();
+
+                DimVector distVecIn(posIn);
+                DimVector distVecEx(posEx);
+                distVecTotal = posEx;
+
+                distVecIn -= posFace;
+                distVecEx -= posFace;
+                distVecTotal -= posIn;
+                absDistTotalSquared = distVecTotal.two_norm2();
+                gravityDistIn = gIn*distVecIn;
+                gravityDistEx = gEx*distVecEx;
+            }
             for (unsigned phaseIdx=0; phaseIdx < numPhases; phaseIdx++) {
                 if (!elemCtx.model().phaseIsConsidered(phaseIdx))
                     continue;
@@ -252,11 +274,11 @@ protected:
                     interiorDofIdx_ == static_cast<int>(focusDofIdx))
                 {
                     const Evaluation& rhoIn = intQuantsIn.fluidState().density(phaseIdx);
-                    pStatIn = - rhoIn*(gIn*distVecIn);
+                    pStatIn = - rhoIn*gravityDistIn;
                 }
                 else {
                     Scalar rhoIn = Toolbox::value(intQuantsIn.fluidState().density(phaseIdx));
-                    pStatIn = - rhoIn*(gIn*distVecIn);
+                    pStatIn = - rhoIn*gravityDistIn;
                 }
 
                 // the quantities on the exterior side of the face do not influence the
@@ -267,11 +289,11 @@ protected:
                     exteriorDofIdx_ == static_cast<int>(focusDofIdx))
                 {
                     const Evaluation& rhoEx = intQuantsEx.fluidState().density(phaseIdx);
-                    pStatEx = - rhoEx*(gEx*distVecEx);
+                    pStatEx = - rhoEx*gravityDistEx;
                 }
                 else {
                     Scalar rhoEx = Toolbox::value(intQuantsEx.fluidState().density(phaseIdx));
-                    pStatEx = - rhoEx*(gEx*distVecEx);
+                    pStatEx = - rhoEx*gravityDistEx;
                 }
 
                 // compute the hydrostatic gradient between the two control volumes (this
@@ -295,7 +317,10 @@ protected:
         }
 
         Opm::Valgrind::SetUndefined(K_);
-        elemCtx.problem().intersectionIntrinsicPermeability(K_, elemCtx, faceIdx, timeIdx);
+        if (cachedQuantities)
+            K_ = cachedQuantities->intrinsicPermeability;
+        else
+            problem.intersectionIntrinsicPermeability(K_, elemCtx, faceIdx, timeIdx);
         Opm::Valgrind::CheckDefined(K_);
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
@@ -369,7 +394,7 @@ protected:
         K_ = intQuantsIn.intrinsicPermeability();
 
         // correct the pressure gradients by the gravitational acceleration
-        if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity)) {
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, EnableGravity)) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
@@ -122,6 +122,9 @@ SET_TYPE_PROP(MultiPhaseBaseModel,
 //! disable gravity by default
 SET_BOOL_PROP(MultiPhaseBaseModel, EnableGravity, false);
 
+//! the permeabilities of the faces may depend on time, so they are not cached by default
+SET_BOOL_PROP(MultiPhaseBaseModel, EnableIntersectionQuantityCache, false);
+
 
 END_PROPERTIES
 
@@ -190,7 +193,7 @@ public:
 
         storage = 0;
 
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView(), ThreadManager::chunkSize());
         std::mutex mutex;
 #ifdef _OPENMP
 #pragma omp parallel
@@ -41,11 +41,16 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 BEGIN_PROPERTIES
 
 NEW_PROP_TAG(SolidEnergyLawParams);
 NEW_PROP_TAG(ThermalConductionLawParams);
 NEW_PROP_TAG(EnableGravity);
+NEW_PROP_TAG(EnableIntersectionQuantityCache);
 NEW_PROP_TAG(FluxModule);
 
 END_PROPERTIES
@@ -70,6 +75,7 @@ class MultiPhaseBaseProblem
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Evaluation) Evaluation;
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
     typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
     typedef typename GET_PROP_TYPE(TypeTag, SolidEnergyLawParams) SolidEnergyLawParams;
@@ -83,6 +89,30 @@ class MultiPhaseBaseProblem
 //! \endcond
 
 public:
+    /*!
+     * \brief The quantities of an interior face which do not depend on the solution.
+     */
+    struct IntersectionQuantities
+    {
+        //! The intrinsic permeability of the face
+        DimMatrix intrinsicPermeability;
+
+        //! The vector from the center of the face's interior degree of freedom to the
+        //! one of its exterior degree of freedom
+        DimVector distVecTotal;
+
+        //! The squared length of distVecTotal
+        Scalar absDistTotalSquared;
+
+        //! The gravitational acceleration times the vector from the integration point of
+        //! the face to the center of the interior degree of freedom
+        Scalar gravityDistIn;
+
+        //! The gravitational acceleration times the vector from the integration point of
+        //! the face to the center of the exterior degree of freedom
+        Scalar gravityDistEx;
+    };
+
     /*!
      * \copydoc Problem::FvBaseProblem(Simulator& )
      */
@@ -99,6 +129,70 @@ public:
 
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableGravity,
                              "Use the gravity correction for the pressure gradients.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntersectionQuantityCache,
+                             "Compute the intrinsic permeabilities of the faces and the "
+                             "geometric quantities needed for the gravity correction only "
+                             "once. This requires them to be constant in time.");
+    }
+
+    /*!
+     * \copydoc FvBaseProblem::finishInit()
+     */
+    void finishInit()
+    {
+        ParentType::finishInit();
+
+        invalidateIntersectionQuantityCache();
+    }
+
+    /*!
+     * \copydoc FvBaseProblem::gridChanged()
+     */
+    void gridChanged()
+    {
+        ParentType::gridChanged();
+
+        invalidateIntersectionQuantityCache();
+    }
+
+    /*!
+     * \brief Returns true iff the quantities of the interior faces which do not depend
+     *        on the solution are only computed once.
+     */
+    bool enableIntersectionQuantityCache() const
+    { return enableIntersectionQuantityCache_; }
+
+    /*!
+     * \brief Causes the cached quantities of the interior faces to be recomputed the
+     *        next time they are accessed.
+     *
+     * Problems must call this method if the permeability of the porous medium or the
+     * gravitational acceleration are changed after the initialization.
+     */
+    void invalidateIntersectionQuantityCache()
+    { intersectionQuantityCacheIsValid_ = false; }
+
+    /*!
+     * \brief Returns the quantities of an interior face which do not depend on the
+     *        solution.
+     *
+     * This may only be called if the cache of these quantities is enabled. If the cache
+     * has been invalidated, it is recomputed before the quantities are returned. This is
+     * done lazily to make sure that the problem is fully initialized at this point,
+     * i.e., finishInit() of the actual problem has been completed.
+     */
+    template <class Context>
+    const IntersectionQuantities& intersectionQuantities(const Context& context,
+                                                         unsigned intersectionIdx,
+                                                         unsigned timeIdx OPM_UNUSED) const
+    {
+        assert(enableIntersectionQuantityCache_);
+
+        if (!intersectionQuantityCacheIsValid_.load(std::memory_order_acquire))
+            updateIntersectionQuantityCache_();
+
+        unsigned elemIdx = static_cast<unsigned>(this->elementMapper().index(context.element()));
+        return intersectionQuantities_[intersectionQuantityOffsets_[elemIdx] + intersectionIdx];
     }
 
     /*!
@@ -401,7 +495,83 @@ private:
         gravity_ = 0.0;
         if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity))
             gravity_[dimWorld-1]  = -9.81;
+
+        enableIntersectionQuantityCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableIntersectionQuantityCache);
+        intersectionQuantityCacheIsValid_ = false;
     }
+
+    // compute the quantities of all interior faces which do not depend on the solution.
+    // this may be called concurrently by multiple threads, but only the first one
+    // computes anything.
+    void updateIntersectionQuantityCache_() const
+    {
+        std::lock_guard<std::mutex> lock(intersectionQuantityCacheMutex_);
+        if (intersectionQuantityCacheIsValid_.load(std::memory_order_relaxed))
+            return;
+
+        bool enableGravity = EWOMS_GET_PARAM(TypeTag, bool, EnableGravity);
+
+        const auto& gridView = this->gridView();
+        intersectionQuantityOffsets_.resize(static_cast<size_t>(gridView.size(/*codim=*/0)));
+        intersectionQuantities_.clear();
+
+        ElementContext elemCtx(this->simulator());
+        ElementIterator elemIt = gridView.template begin</*codim=*/0>();
+        const ElementIterator& elemEndIt = gridView.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const auto& elem = *elemIt;
+            elemCtx.updateStencil(elem);
+
+            unsigned elemIdx = static_cast<unsigned>(this->elementMapper().index(elem));
+            intersectionQuantityOffsets_[elemIdx] = intersectionQuantities_.size();
+
+            const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+            size_t numInteriorFaces = elemCtx.numInteriorFaces(/*timeIdx=*/0);
+            for (unsigned faceIdx = 0; faceIdx < numInteriorFaces; ++faceIdx) {
+                IntersectionQuantities quantities;
+                asImp_().intersectionIntrinsicPermeability(quantities.intrinsicPermeability,
+                                                           elemCtx,
+                                                           faceIdx,
+                                                           /*timeIdx=*/0);
+
+                // the same quantities as used by the gravity correction of the Darcy
+                // flux module
+                const auto& scvf = stencil.interiorFace(faceIdx);
+                unsigned i = scvf.interiorIndex();
+                unsigned j = scvf.exteriorIndex();
+                const auto& posIn = elemCtx.pos(i, /*timeIdx=*/0);
+                const auto& posEx = elemCtx.pos(j, /*timeIdx=*/0);
+
+                quantities.distVecTotal = posEx;
+                quantities.distVecTotal -= posIn;
+                quantities.absDistTotalSquared = quantities.distVecTotal.two_norm2();
+
+                quantities.gravityDistIn = 0.0;
+                quantities.gravityDistEx = 0.0;
+                if (enableGravity) {
+                    const auto& posFace = scvf.integrationPos();
+
+                    DimVector distVecIn(posIn);
+                    DimVector distVecEx(posEx);
+                    distVecIn -= posFace;
+                    distVecEx -= posFace;
+
+                    quantities.gravityDistIn = asImp_().gravity(elemCtx, i, /*timeIdx=*/0)*distVecIn;
+                    quantities.gravityDistEx = asImp_().gravity(elemCtx, j, /*timeIdx=*/0)*distVecEx;
+                }
+
+                intersectionQuantities_.push_back(quantities);
+            }
+        }
+
+        intersectionQuantityCacheIsValid_.store(true, std::memory_order_release);
+    }
+
+    bool enableIntersectionQuantityCache_;
+    mutable std::atomic<bool> intersectionQuantityCacheIsValid_;
+    mutable std::mutex intersectionQuantityCacheMutex_;
+    mutable std::vector<size_t> intersectionQuantityOffsets_;
+    mutable std::vector<IntersectionQuantities> intersectionQuantities_;
 };
 
 } // namespace Opm
@@ -64,6 +64,10 @@ NEW_PROP_TAG(FluxModule);
 //! Returns whether gravity is considered in the problem
 NEW_PROP_TAG(EnableGravity);
 
+//! Specify whether the intrinsic permeabilities of the faces and the geometric quantities
+//! required for the gravity correction are only computed once
+NEW_PROP_TAG(EnableIntersectionQuantityCache);
+
 END_PROPERTIES
 
 #endif
@@ -30,6 +30,9 @@
 #include <opm/models/utils/propertysystem.hh>
 
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
+
+#include <opm/material/common/Unused.hpp>
 
 #include <set>
 #include <vector>
@@ -110,6 +113,26 @@ public:
      */
     virtual void addNeighbors(std::vector<NeighborSet>& neighbors) const = 0;
 
+    /*!
+     * \brief Add the additional neighboring correlations caused by the auxiliary
+     *        module to the sparsity pattern of the Jacobian matrix.
+     *
+     * This is the method which is called by the linearizer. By default, it forwards to
+     * addNeighbors() using a temporary std::set for each degree of freedom. Note that
+     * these sets are initially empty, i.e., they do not contain the neighbors which
+     * stem from the grid. Auxiliary modules which can add their entries directly
+     * should override this method to avoid the temporary sets.
+     */
+    virtual void addSparsityPatternEntries(Opm::Linear::SparsityPattern& sparsityPattern) const
+    {
+        std::vector<NeighborSet> neighbors(sparsityPattern.numRows());
+        addNeighbors(neighbors);
+
+        for (unsigned rowIdx = 0; rowIdx < neighbors.size(); ++rowIdx)
+            for (unsigned colIdx : neighbors[rowIdx])
+                sparsityPattern.addEntry(rowIdx, colIdx);
+    }
+
     /*!
      * \brief Set the initial condition of the auxiliary module in the solution vector.
      */
@@ -91,6 +91,13 @@ namespace Opm {
  *
  * This class uses automatic differentiation to calculate the partial derivatives (the
  * alternative is finite differences).
+ *
+ * Note that each interior face of the grid is evaluated twice: once by each of its
+ * adjacent elements, with the derivatives taken with regard to the primary variables
+ * of the respective element. Evaluating every face only once would require the flux
+ * code of the models to work on evaluations which carry the derivatives of both
+ * neighbors, i.e., on an evaluation type with 2*numEq derivatives, instead of the
+ * model-wide Evaluation type used for the intensive quantities.
  */
 template<class TypeTag>
 class FvBaseAdLocalLinearizer
@@ -106,6 +113,7 @@ private:
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
     typedef typename GridView::template Codim<0>::Entity Element;
+    typedef typename LocalResidual::LocalEvalBlockVector LocalEvalBlockVector;
 
     enum { numEq = GET_PROP_VALUE(TypeTag, NumEq) };
 
@@ -207,6 +215,41 @@ public:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of an element without computing its local Jacobian
+     *        matrix.
+     *
+     * After calling this method, residual() contains the residual of all degrees of
+     * freedom of the element's stencil, while the contents of the local Jacobian matrix
+     * are unspecified.
+     *
+     * Note that the quantities of the element context are evaluations, i.e., the
+     * partial derivatives with regard to the primary variables of the first degree of
+     * freedom are still calculated. Compared to linearize(), this method only saves the
+     * evaluations for the remaining primary degrees of freedom of the stencil and the
+     * conversion of the local Jacobian matrix.
+     *
+     * \param elemCtx The element execution context which is to be used
+     * \param elem The grid element for which the residual ought to be evaluated
+     */
+    void evalResidual(ElementContext& elemCtx, const Element& elem)
+    {
+        // a single evaluation is sufficient because the values of the residual do not
+        // depend on the degree of freedom for which the derivatives are calculated. the
+        // derivatives with regard to the focus degree of freedom are computed anyway and
+        // simply discarded.
+        elemCtx.updateAll(elem);
+
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        residual_.resize(numDof);
+        evalResidual_.resize(numDof);
+        localResidual_.eval(evalResidual_, elemCtx);
+
+        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++)
+            for (unsigned eqIdx = 0; eqIdx < numEq; eqIdx++)
+                residual_[dofIdx][eqIdx] = evalResidual_[dofIdx][eqIdx].value();
+    }
+
     /*!
      * \brief Return reference to the local residual.
      */
@@ -309,6 +352,10 @@ protected:
 
     ScalarLocalBlockVector residual_;
     ScalarLocalBlockMatrix jacobian_;
+
+    // the residual of the element in terms of evaluations. this is only used by
+    // evalResidual()
+    LocalEvalBlockVector evalResidual_;
 };
 
 } // namespace Opm
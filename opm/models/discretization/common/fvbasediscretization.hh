@@ -49,6 +49,7 @@
 
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
+#include <opm/models/parallel/atomicbitvector.hh>
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/alignedallocator.hh>
@@ -77,6 +78,8 @@
 #include <dune/fem/misc/capabilities.hh>
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <list>
 #include <sstream>
@@ -207,7 +210,12 @@ SET_TYPE_PROP(FvBaseDiscretization, ConstraintsContext, Opm::FvBaseConstraintsCo
  */
 SET_TYPE_PROP(FvBaseDiscretization, ThreadManager, Opm::ThreadManager<TypeTag>);
 SET_INT_PROP(FvBaseDiscretization, ThreadsPerProcess, 1);
+SET_INT_PROP(FvBaseDiscretization, ThreadedLoopChunkSize, 16);
+
+//! By default, the finite volume geometry of the elements is computed on the fly
+SET_BOOL_PROP(FvBaseDiscretization, EnableStencilCache, false);
 SET_BOOL_PROP(FvBaseDiscretization, UseLinearizationLock, true);
+SET_BOOL_PROP(FvBaseDiscretization, EnableColoredLinearization, false);
 
 /*!
  * \brief Linearizer for the global system of equations.
@@ -220,6 +228,18 @@ SET_SCALAR_PROP(FvBaseDiscretization, MaxTimeStepSize, std::numeric_limits<Scala
 //! By default, accept any time step larger than zero
 SET_SCALAR_PROP(FvBaseDiscretization, MinTimeStepSize, 0.0);
 
+//! By default, the size of the time steps is suggested by the Newton method
+SET_STRING_PROP(FvBaseDiscretization, TimeStepControl, "newton");
+SET_BOOL_PROP(FvBaseDiscretization, TimeStepControlRememberFailures, false);
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlFailureMemory, 5.0);
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlFailureMaxGrowth, 1.25);
+SET_INT_PROP(FvBaseDiscretization, TimeStepControlTargetIterations, 10);
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlDecayRate, 0.75);
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlGrowthRate, 1.25);
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlTolerance, 0.1);
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlMaxGrowth, 3.0);
+SET_INT_PROP(FvBaseDiscretization, TimeStepControlVerbosity, 0);
+
 //! Disable grid adaptation by default
 SET_BOOL_PROP(FvBaseDiscretization, EnableGridAdaptation, false);
 
@@ -240,6 +260,10 @@ SET_INT_PROP(FvBaseDiscretization, VtkOutputFormat, Dune::VTK::ascii);
 // disable caching the storage term by default
 SET_BOOL_PROP(FvBaseDiscretization, EnableStorageCache, false);
 
+// do not keep the intensive quantities of the initial solution of a time step by
+// default because this doubles the memory required by the intensive quantity cache
+SET_BOOL_PROP(FvBaseDiscretization, EnableIntensiveQuantityCheckpoint, false);
+
 // disable constraints by default
 SET_BOOL_PROP(FvBaseDiscretization, EnableConstraints, false);
 
@@ -399,7 +423,11 @@ public:
         , enableIntensiveQuantityCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCache))
         , enableStorageCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache))
         , enableThermodynamicHints_(EWOMS_GET_PARAM(TypeTag, bool, EnableThermodynamicHints))
+        , enableIntensiveQuantityCheckpoint_(EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCheckpoint))
     {
+        intensiveQuantityCacheAliasIdx_ = 0;
+        intensiveQuantityCheckpointOpen_ = false;
+
 #if HAVE_DUNE_FEM
         if (enableGridAdaptation_ && !Dune::Fem::Capabilities::isLocallyAdaptive<Grid>::v)
             throw std::invalid_argument("Grid adaptation enabled, but chosen Grid is not capable"
@@ -421,9 +449,10 @@ public:
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
             solution_[timeIdx].reset(new DiscreteFunction("solution", space_));
 
-            if (storeIntensiveQuantities()) {
+            if (storeIntensiveQuantities() && intensiveQuantitiesCachedFor_(timeIdx)) {
                 intensiveQuantityCache_[timeIdx].resize(numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof, /*value=*/false);
+                intensiveQuantityCacheClaimed_[timeIdx].resize(numDof, /*value=*/false);
             }
 
             if (enableStorageCache_)
@@ -466,6 +495,10 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableThermodynamicHints, "Enable thermodynamic hints");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCache, "Turn on caching of intensive quantities");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStorageCache, "Store previous storage terms and avoid re-calculating them.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCheckpoint,
+                             "Keep the cached intensive quantities of the initial solution of a "
+                             "time step for retrying it. This requires the storage cache and "
+                             "doubles the memory used by the intensive quantity cache.");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, OutputDir, "The directory to which result files are written");
     }
 
@@ -474,6 +507,10 @@ public:
      */
     void finishInit()
     {
+        // the grid may have changed, so the cached geometry needs to be updated before
+        // any stencil is used
+        asImp_().updateStencilCache();
+
         // initialize the volume of the finite volumes to zero
         size_t numDof = asImp_().numGridDof();
         dofTotalVolume_.resize(numDof);
@@ -662,21 +699,32 @@ public:
      */
     const IntensiveQuantities* cachedIntensiveQuantities(unsigned globalIdx, unsigned timeIdx) const
     {
-        if (!enableIntensiveQuantityCache_ ||
-            !intensiveQuantityCacheUpToDate_[timeIdx][globalIdx])
+        if (!enableIntensiveQuantityCache_ || !intensiveQuantitiesCachedFor_(timeIdx))
             return 0;
 
-        if (timeIdx > 0 && enableStorageCache_)
-            // with the storage cache enabled, only the intensive quantities for the most
-            // recent time step are cached!
-            return 0;
-
-        return &intensiveQuantityCache_[timeIdx][globalIdx];
+        // the acquire semantics of the test make sure that the cache entry is
+        // completely written if it is flagged as valid
+        if (intensiveQuantityCacheUpToDate_[timeIdx].test(globalIdx))
+            return &intensiveQuantityCacheEntry_(globalIdx, timeIdx);
+
+        // after the history has been shifted, the most recent solution is identical to
+        // the one of the previous time step until it gets modified, i.e., the
+        // intensive quantities of the previous time step can be used for it.
+        if (timeIdx == 0
+            && intensiveQuantityCacheAliasIdx_ > 0
+            && intensiveQuantityCacheAliased_.test(globalIdx, std::memory_order_relaxed)
+            && intensiveQuantityCacheUpToDate_[intensiveQuantityCacheAliasIdx_].test(globalIdx))
+            return &intensiveQuantityCache_[intensiveQuantityCacheAliasIdx_][globalIdx];
+
+        return 0;
     }
 
     /*!
      * \brief Update the intensive quantity cache for a entity on the grid at given time.
      *
+     * This method always overwrites the cache entry. It must not be called concurrently
+     * for the same degree of freedom.
+     *
      * \param intQuants The IntensiveQuantities object hint for a given degree of freedom.
      * \param globalIdx The global space index for the entity where a
      *                  hint is to be set.
@@ -686,11 +734,40 @@ public:
                                          unsigned globalIdx,
                                          unsigned timeIdx) const
     {
-        if (!storeIntensiveQuantities())
+        if (!storeIntensiveQuantities() || !intensiveQuantitiesCachedFor_(timeIdx))
+            return;
+
+        intensiveQuantityCacheClaimed_[timeIdx].set(globalIdx);
+        writeCachedIntensiveQuantities_(intQuants, globalIdx, timeIdx);
+    }
+
+    /*!
+     * \brief Fill the intensive quantity cache for a entity on the grid at given time
+     *        if it does not yet contain a valid entry for it.
+     *
+     * In contrast to updateCachedIntensiveQuantities(), this method may be called
+     * concurrently by multiple threads. If several threads try to fill the same cache
+     * entry, only the first one writes it and the others return immediately because
+     * they have computed identical intensive quantities. This is used by the element
+     * contexts if they did not find a cached entry.
+     *
+     * \param intQuants The IntensiveQuantities object hint for a given degree of freedom.
+     * \param globalIdx The global space index for the entity where a
+     *                  hint is to be set.
+     * \param timeIdx The index used by the time discretization.
+     */
+    void fillCachedIntensiveQuantities(const IntensiveQuantities& intQuants,
+                                       unsigned globalIdx,
+                                       unsigned timeIdx) const
+    {
+        if (!storeIntensiveQuantities() || !intensiveQuantitiesCachedFor_(timeIdx))
+            return;
+
+        if (intensiveQuantityCacheClaimed_[timeIdx].testAndSet(globalIdx))
+            // the entry is either valid or some other thread already writes it
             return;
 
-        intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = true;
+        writeCachedIntensiveQuantities_(intQuants, globalIdx, timeIdx);
     }
 
     /*!
@@ -704,10 +781,18 @@ public:
                                                   unsigned timeIdx,
                                                   bool newValue) const
     {
-        if (!storeIntensiveQuantities())
+        if (!storeIntensiveQuantities() || !intensiveQuantitiesCachedFor_(timeIdx))
             return;
 
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = newValue;
+        intensiveQuantityCacheUpToDate_[timeIdx].set(globalIdx, newValue);
+        intensiveQuantityCacheClaimed_[timeIdx].set(globalIdx, newValue);
+        if (timeIdx == 0 && intensiveQuantityCacheAliasIdx_ > 0)
+            intensiveQuantityCacheAliased_.reset(globalIdx, std::memory_order_relaxed);
+
+        // the entry is invalidated because the solution has been modified, i.e., it no
+        // longer is the initial solution of the time step
+        if (timeIdx == 0 && !newValue)
+            intensiveQuantityCheckpointOpen_.store(false, std::memory_order_relaxed);
     }
 
     /*!
@@ -717,10 +802,13 @@ public:
      */
     void invalidateIntensiveQuantitiesCache(unsigned timeIdx) const
     {
-        if (storeIntensiveQuantities()) {
-            std::fill(intensiveQuantityCacheUpToDate_[timeIdx].begin(),
-                      intensiveQuantityCacheUpToDate_[timeIdx].end(),
-                      /*value=*/false);
+        if (storeIntensiveQuantities() && intensiveQuantitiesCachedFor_(timeIdx)) {
+            intensiveQuantityCacheUpToDate_[timeIdx].fill(/*value=*/false);
+            intensiveQuantityCacheClaimed_[timeIdx].fill(/*value=*/false);
+            if (timeIdx == 0) {
+                intensiveQuantityCacheAliasIdx_ = 0;
+                intensiveQuantityCheckpointOpen_.store(false, std::memory_order_relaxed);
+            }
         }
     }
 
@@ -729,6 +817,11 @@ public:
      *
      * This method should only be called by the time discretization.
      *
+     * The history of the cache is a ring buffer, i.e., it is rotated without copying
+     * any intensive quantities. Until the solution of a degree of freedom is changed,
+     * the intensive quantities of the most recent time index are looked up in the
+     * slot of the time index to which they have been moved.
+     *
      * \param numSlots The number of time step slots for which the
      *                 hints should be shifted.
      */
@@ -744,16 +837,29 @@ public:
             return;
         }
 
-        assert(numSlots > 0);
-
-        for (unsigned timeIdx = 0; timeIdx < historySize - numSlots; ++ timeIdx) {
-            intensiveQuantityCache_[timeIdx + numSlots] = intensiveQuantityCache_[timeIdx];
-            intensiveQuantityCacheUpToDate_[timeIdx + numSlots] = intensiveQuantityCacheUpToDate_[timeIdx];
-        }
-
-        // the cache for the most recent time indices do not need to be invalidated
-        // because the solution for them did not change (TODO: that assumes that there is
+        assert(0 < numSlots && numSlots < historySize);
+
+        // rotate the slots of the history to the back. this only swaps the pointers of
+        // the containers.
+        unsigned firstMovedIdx = historySize - numSlots;
+        std::rotate(intensiveQuantityCache_,
+                    intensiveQuantityCache_ + firstMovedIdx,
+                    intensiveQuantityCache_ + historySize);
+        std::rotate(intensiveQuantityCacheUpToDate_,
+                    intensiveQuantityCacheUpToDate_ + firstMovedIdx,
+                    intensiveQuantityCacheUpToDate_ + historySize);
+        std::rotate(intensiveQuantityCacheClaimed_,
+                    intensiveQuantityCacheClaimed_ + firstMovedIdx,
+                    intensiveQuantityCacheClaimed_ + historySize);
+
+        // the slots which ended up at the front contain outdated quantities
+        for (unsigned timeIdx = 0; timeIdx < numSlots; ++ timeIdx)
+            invalidateIntensiveQuantitiesCache(timeIdx);
+
+        // the cache for the most recent time index does not need to be recomputed
+        // because the solution for it did not change (TODO: that assumes that there is
         // no post-processing of the solution after a time step! fix it?)
+        aliasIntensiveQuantitiesCache_(/*aliasIdx=*/numSlots);
     }
 
     /*!
@@ -825,8 +931,9 @@ public:
     {
         dest = 0;
 
+        const bool useLock = GET_PROP_VALUE(TypeTag, UseLinearizationLock);
         std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_, ThreadManager::chunkSize());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -848,14 +955,18 @@ public:
                 storageTerm.resize(elemCtx.numPrimaryDof(/*timeIdx=*/0));
                 asImp_().localResidual(threadId).eval(residual, elemCtx);
 
+                // if the elements only write to their own degrees of freedom (e.g., for
+                // cell centered finite volumes), no lock is required
                 size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
-                mutex.lock();
+                if (useLock)
+                    mutex.lock();
                 for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
                     unsigned globalI = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
                     for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
                         dest[globalI][eqIdx] += Toolbox::value(residual[dofIdx][eqIdx]);
                 }
-                mutex.unlock();
+                if (useLock)
+                    mutex.unlock();
             }
         }
 
@@ -887,7 +998,7 @@ public:
         storage = 0;
 
         std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView(), ThreadManager::chunkSize());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1206,6 +1317,11 @@ public:
         solveTimer_.halt();
         updateTimer_.halt();
 
+        // the cache entries which are valid at this point belong to the initial
+        // solution of the time step
+        if (useIntensiveQuantityCheckpoint_())
+            beginIntensiveQuantityCheckpoint_();
+
         prePostProcessTimer_.start();
         asImp_().updateBegin();
         prePostProcessTimer_.stop();
@@ -1343,6 +1459,18 @@ public:
         solution(/*timeIdx=*/0) = solution(/*timeIdx=*/1);
         invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
 
+        // the intensive quantities of the previous time step are still valid for the
+        // restored solution
+        if (!enableStorageCache_)
+            aliasIntensiveQuantitiesCache_(/*aliasIdx=*/1);
+        else if (useIntensiveQuantityCheckpoint_()
+                 && simulator_.problem().recycleFirstIterationStorage())
+            // the checkpointed intensive quantities belong to the initial solution of
+            // the time step, i.e., they can be used for the retry. (the
+            // storage terms of the previous time step are left alone by failed time
+            // steps, so the storage cache is still valid.)
+            restoreIntensiveQuantityCheckpoint_();
+
 #ifndef NDEBUG
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
             // Make sure that the primary variables are defined. Note that because of padding
@@ -1366,7 +1494,10 @@ public:
         // at this point we can adapt the grid
         asImp_().adaptGrid();
 
-        // make the current solution the previous one.
+        // make the current solution the previous one. Note that the solution cannot
+        // be rotated like the intensive quantities cache because the current solution
+        // is the initial guess for the next time step and thus is required in both
+        // places.
         solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0);
 
         // shift the intensive quantities cache by one position in the
@@ -1449,6 +1580,26 @@ public:
         }
     }
 
+    /*!
+     * \brief Recompute the cached finite volume geometry of the grid.
+     *
+     * This is called whenever the grid may have changed. By default, the discretization
+     * does not cache anything.
+     */
+    void updateStencilCache()
+    { }
+
+    /*!
+     * \brief Make a stencil object use the cached finite volume geometry of the grid.
+     *
+     * By default, the discretization does not cache anything, so the stencil is not
+     * modified.
+     *
+     * \param stencil The stencil object which ought to use the cache
+     */
+    void attachStencilCache(Stencil& stencil OPM_UNUSED) const
+    { }
+
     /*!
      * \brief Returns the number of degrees of freedom (DOFs) for the computational grid
      */
@@ -1658,7 +1809,7 @@ public:
         }
 
         // iterate over grid
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView(), ThreadManager::chunkSize());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1802,6 +1953,108 @@ public:
     { return updateTimer_; }
 
 protected:
+    // returns true if the intensive quantities of a given time index are kept by the
+    // cache. if the storage term is cached, the intensive quantities of the previous
+    // time steps are never accessed because the storage cache provides all the
+    // (scalar) information which is required about them.
+    bool intensiveQuantitiesCachedFor_(unsigned timeIdx) const
+    { return timeIdx == 0 || !enableStorageCache_; }
+
+    // make the cached intensive quantities of a given time index available for the
+    // most recent time index if no quantities have been cached for the latter
+    void aliasIntensiveQuantitiesCache_(unsigned aliasIdx)
+    {
+        if (!storeIntensiveQuantities())
+            return;
+
+        intensiveQuantityCacheAliasIdx_ = aliasIdx;
+        intensiveQuantityCacheAliased_.resize(intensiveQuantityCache_[0].size(), /*value=*/true);
+    }
+
+    // returns true if the cached intensive quantities of the initial solution of a time
+    // step are kept for retrying it. This is only useful if the storage term is cached
+    // because the intensive quantities of the previous time step are available
+    // otherwise.
+    bool useIntensiveQuantityCheckpoint_() const
+    {
+        return enableIntensiveQuantityCheckpoint_
+            && enableStorageCache_
+            && storeIntensiveQuantities();
+    }
+
+    // write a cache entry which has been claimed by the calling thread and flag it as
+    // valid afterwards
+    void writeCachedIntensiveQuantities_(const IntensiveQuantities& intQuants,
+                                         unsigned globalIdx,
+                                         unsigned timeIdx) const
+    {
+        if (timeIdx == 0 && useIntensiveQuantityCheckpoint_())
+            updateIntensiveQuantityCheckpoint_(globalIdx);
+
+        intensiveQuantityCacheEntry_(globalIdx, timeIdx) = intQuants;
+        intensiveQuantityCacheUpToDate_[timeIdx].set(globalIdx);
+    }
+
+    // returns the object in which the cached intensive quantities of a DOF are stored
+    IntensiveQuantities& intensiveQuantityCacheEntry_(unsigned globalIdx, unsigned timeIdx) const
+    {
+        if (timeIdx == 0
+            && useIntensiveQuantityCheckpoint_()
+            && intensiveQuantityCacheSlot_.test(globalIdx, std::memory_order_relaxed))
+            return intensiveQuantitySpareCache_[globalIdx];
+
+        return intensiveQuantityCache_[timeIdx][globalIdx];
+    }
+
+    // start recording the checkpoint for the current solution. this is called at the
+    // beginning of each attempt of a time step, i.e., the current solution is the
+    // initial one of the time step and the valid cache entries belong to it.
+    void beginIntensiveQuantityCheckpoint_()
+    {
+        for (auto& movedDofs : intensiveQuantityCheckpointMovedDofs_)
+            movedDofs.clear();
+
+        intensiveQuantityCheckpointed_ = intensiveQuantityCacheUpToDate_[0];
+        intensiveQuantityCheckpointOpen_.store(true, std::memory_order_relaxed);
+    }
+
+    // called by the thread which claimed the cache entry of a DOF for time index 0
+    // before it is written
+    void updateIntensiveQuantityCheckpoint_(unsigned globalIdx) const
+    {
+        if (intensiveQuantityCheckpointOpen_.load(std::memory_order_relaxed))
+            // the solution has not been modified since the beginning of the time step,
+            // i.e., the quantities become part of the checkpoint
+            intensiveQuantityCheckpointed_.set(globalIdx, true, std::memory_order_relaxed);
+        else if (intensiveQuantityCheckpointed_.test(globalIdx, std::memory_order_relaxed)) {
+            // do not overwrite the checkpoint but use the other slot for the DOF. since
+            // the flag of the checkpoint is reset, this happens at most once per DOF.
+            bool slot = intensiveQuantityCacheSlot_.test(globalIdx, std::memory_order_relaxed);
+            intensiveQuantityCacheSlot_.set(globalIdx, !slot, std::memory_order_relaxed);
+            intensiveQuantityCheckpointed_.reset(globalIdx, std::memory_order_relaxed);
+            intensiveQuantityCheckpointMovedDofs_[ThreadManager::threadId()].push_back(globalIdx);
+        }
+    }
+
+    // make the checkpointed intensive quantities the valid cache entries for time index
+    // 0. this only flips the slots of the DOFs which have been written since the
+    // checkpoint was recorded, i.e., no intensive quantities are copied and no loop
+    // over all DOFs is required.
+    void restoreIntensiveQuantityCheckpoint_()
+    {
+        for (auto& movedDofs : intensiveQuantityCheckpointMovedDofs_) {
+            for (unsigned globalIdx : movedDofs) {
+                bool slot = intensiveQuantityCacheSlot_.test(globalIdx, std::memory_order_relaxed);
+                intensiveQuantityCacheSlot_.set(globalIdx, !slot, std::memory_order_relaxed);
+                intensiveQuantityCheckpointed_.set(globalIdx, true, std::memory_order_relaxed);
+            }
+            movedDofs.clear();
+        }
+
+        intensiveQuantityCacheUpToDate_[0] = intensiveQuantityCheckpointed_;
+        intensiveQuantityCacheClaimed_[0] = intensiveQuantityCheckpointed_;
+    }
+
     void resizeAndResetIntensiveQuantitiesCache_()
     {
         // allocate the storage cache
@@ -1816,10 +2069,24 @@ protected:
         if (storeIntensiveQuantities()) {
             size_t numDof = asImp_().numGridDof();
             for(unsigned timeIdx=0; timeIdx<historySize; ++timeIdx) {
+                if (!intensiveQuantitiesCachedFor_(timeIdx))
+                    continue;
+
                 intensiveQuantityCache_[timeIdx].resize(numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof);
+                intensiveQuantityCacheClaimed_[timeIdx].resize(numDof);
                 invalidateIntensiveQuantitiesCache(timeIdx);
             }
+
+            if (useIntensiveQuantityCheckpoint_()) {
+                intensiveQuantitySpareCache_.resize(numDof);
+                intensiveQuantityCacheSlot_.resize(numDof, /*value=*/false);
+                intensiveQuantityCheckpointed_.resize(numDof, /*value=*/false);
+                intensiveQuantityCheckpointMovedDofs_.resize(ThreadManager::maxThreads());
+                for (auto& movedDofs : intensiveQuantityCheckpointMovedDofs_)
+                    movedDofs.clear();
+                intensiveQuantityCheckpointOpen_ = false;
+            }
         }
     }
     template <class Context>
@@ -1890,7 +2157,27 @@ protected:
     // cur is the current iterative solution, prev the converged
     // solution of the previous time step
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
-    mutable std::vector<bool> intensiveQuantityCacheUpToDate_[historySize];
+    mutable Opm::AtomicBitVector intensiveQuantityCacheUpToDate_[historySize];
+    // flags the entries which are currently written or are already up to date
+    mutable Opm::AtomicBitVector intensiveQuantityCacheClaimed_[historySize];
+    // if non-zero, the time index whose cached intensive quantities are also valid
+    // for the entries of time index 0 which are flagged by intensiveQuantityCacheAliased_
+    mutable unsigned intensiveQuantityCacheAliasIdx_;
+    mutable Opm::AtomicBitVector intensiveQuantityCacheAliased_;
+    // if enabled, the intensive quantities of the initial solution of a time step are
+    // kept as a checkpoint for retrying it. to avoid copying them, the entries of time
+    // index 0 are double buffered: intensiveQuantityCacheSlot_ flags the DOFs whose
+    // current entry is stored in intensiveQuantitySpareCache_.
+    mutable IntensiveQuantitiesVector intensiveQuantitySpareCache_;
+    mutable Opm::AtomicBitVector intensiveQuantityCacheSlot_;
+    // flags the DOFs whose current entry is the checkpoint
+    mutable Opm::AtomicBitVector intensiveQuantityCheckpointed_;
+    // the DOFs whose checkpoint is stored in the slot which is not current. each
+    // thread records the DOFs which it has moved in its own list.
+    mutable std::vector<std::vector<unsigned> > intensiveQuantityCheckpointMovedDofs_;
+    // true as long as the solution has not been modified since the beginning of the
+    // time step, i.e., if the cache entries which are written are part of the checkpoint
+    mutable std::atomic<bool> intensiveQuantityCheckpointOpen_;
 
     DiscreteFunctionSpace space_;
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
@@ -1913,6 +2200,7 @@ protected:
     bool enableIntensiveQuantityCache_;
     bool enableStorageCache_;
     bool enableThermodynamicHints_;
+    bool enableIntensiveQuantityCheckpoint_;
 };
 } // namespace Opm
 
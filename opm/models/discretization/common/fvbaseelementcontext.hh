@@ -97,6 +97,7 @@ public:
     {
         // remember the simulator object
         simulatorPtr_ = &simulator;
+        simulator.model().attachStencilCache(stencil_);
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
@@ -565,9 +566,9 @@ protected:
             }
             else {
                 updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
-                model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
-                                                        globalIdx,
-                                                        timeIdx);
+                model().fillCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
+                                                      globalIdx,
+                                                      timeIdx);
             }
         }
     }
@@ -258,6 +258,27 @@ public:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of an element without computing its local Jacobian
+     *        matrix.
+     *
+     * After calling this method, residual() contains the residual of all degrees of
+     * freedom of the element's stencil, while the contents of the local Jacobian matrix
+     * are unspecified.
+     *
+     * \param elemCtx The element execution context which is to be used
+     * \param elem The grid element for which the residual ought to be evaluated
+     */
+    void evalResidual(ElementContext& elemCtx, const Element& elem)
+    {
+        // the finite difference linearizer operates on scalars anyway, so the only thing
+        // which needs to be done is to skip the numeric differentiation
+        elemCtx.updateAll(elem);
+
+        residual_.resize(elemCtx.numDof(/*timeIdx=*/0));
+        localResidual_.eval(residual_, elemCtx);
+    }
+
     /*!
      * \brief Returns the unweighted epsilon value used to calculate
      *        the local derivatives
@@ -336,7 +357,7 @@ protected:
      * \brief Returns the numeric difference method which is applied.
      */
     static int numericDifferenceMethod_()
-    { return EWOMS_GET_PARAM(TypeTag, int, NumericDifferenceMethod); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, int, NumericDifferenceMethod); }
 
     /*!
      * \brief Resize all internal attributes to the size of the
@@ -33,7 +33,9 @@
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/models/parallel/elementcoloring.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
 
 #include <opm/material/common/Exceptions.hpp>
 
@@ -45,9 +47,10 @@
 #include <iostream>
 #include <vector>
 #include <thread>
-#include <set>
+#include <map>
 #include <exception>   // current_exception, rethrow_exception
 #include <mutex>
+#include <atomic>
 
 namespace Opm {
 // forward declarations
@@ -92,6 +95,7 @@ class FvBaseLinearizer
 
     typedef typename GridView::template Codim<0>::Entity Element;
     typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef ThreadedEntityIterator<GridView, /*codim=*/0> ThreadedElementIterator;
 
     typedef GlobalEqVector Vector;
 
@@ -112,6 +116,7 @@ class FvBaseLinearizer
 public:
     FvBaseLinearizer()
         : jacobian_()
+        , enableColoredLinearization_(false)
     {
         simulatorPtr_ = 0;
     }
@@ -128,7 +133,12 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableColoredLinearization,
+                             "Linearize the elements in sets which do not share any primary "
+                             "degree of freedom. This allows for lock-free multi-threaded "
+                             "assembly.");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -142,6 +152,7 @@ public:
     void init(Simulator& simulator)
     {
         simulatorPtr_ = &simulator;
+        enableColoredLinearization_ = EWOMS_GET_PARAM(TypeTag, bool, EnableColoredLinearization);
         eraseMatrix();
     }
 
@@ -220,6 +231,56 @@ public:
             throw Opm::NumericalIssue("A process did not succeed in linearizing the system");
     }
 
+    /*!
+     * \brief Evaluate the residual of the part of the non-linear system of equations
+     *        that is associated with the spatial domain without linearizing it.
+     *
+     * The Jacobian matrix is left untouched, i.e., it still corresponds to the solution
+     * for which linearizeDomain() has been called the last time. Since the auxiliary
+     * modules always linearize their equations, this method may only be used if the
+     * model does not feature any auxiliary module.
+     *
+     * For models which use finite differences, this skips the numeric differentiation.
+     * For models which use automatic differentiation, the local residuals are still
+     * evaluations, i.e., the partial derivatives with regard to one degree of freedom
+     * per element are computed. In this case, only the evaluations for the remaining
+     * degrees of freedom of the stencil and the assembly of the Jacobian matrix are
+     * saved.
+     */
+    void evaluateDomainResidual()
+    {
+        if (!jacobian_)
+            throw std::logic_error("The residual can only be evaluated on its own after "
+                                   "the system has been linearized");
+        if (model_().numAuxiliaryModules() > 0)
+            throw std::logic_error("The residual cannot be evaluated on its own if "
+                                   "auxiliary modules are present");
+
+        int succeeded;
+        try {
+            evaluateResidual_();
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = gridView_().comm().min(succeeded);
+
+        if (!succeeded)
+            throw Opm::NumericalIssue("A process did not succeed in evaluating the residual");
+    }
+
     void finalize()
     { jacobian_->finalize(); }
 
@@ -282,6 +343,15 @@ public:
     GlobalEqVector& residual()
     { return residual_; }
 
+    /*!
+     * \brief Returns true iff the elements are linearized color by color.
+     *
+     * In this case, no locking is required to assemble the global system of equations
+     * in multi-threaded mode.
+     */
+    bool enableColoredLinearization() const
+    { return enableColoredLinearization_; }
+
     /*!
      * \brief Returns the map of constraint degrees of freedom.
      *
@@ -334,40 +404,102 @@ private:
     void createMatrix_()
     {
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
 
-        // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        typedef std::set< unsigned > NeighborSet;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
+        // the iterators to the first element of each chunk of the threaded element
+        // loops only need to be determined once per grid
+        ThreadedElementIterator::computeChunkBegins(elementChunkBegins_,
+                                                    gridView_(),
+                                                    ThreadManager::chunkSize());
 
-        ElementIterator elemIt = gridView_().template begin<0>();
-        const ElementIterator elemEndIt = gridView_().template end<0>();
-        for (; elemIt != elemEndIt; ++elemIt) {
-            const Element& elem = *elemIt;
-            stencil.update(elem);
-
-            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+        // for the main model, find out the global indices of the neighboring degrees of
+        // freedom of each primary degree of freedom. This is done using two passes over
+        // the grid: the first one determines an upper bound for the number of neighbors
+        // of each degree of freedom and the second one adds the actual neighbors.
+        Opm::Linear::SparsityPattern sparsityPattern(model.numTotalDof());
+        for (unsigned passIdx = 0; passIdx < 2; ++passIdx) {
+            ThreadedElementIterator threadedElemIt(gridView_(), elementChunkBegins_, ThreadManager::chunkSize());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                Stencil threadStencil(gridView_(), model.dofMapper());
+                model.attachStencilCache(threadStencil);
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    threadStencil.update(*elemIt);
+
+                    unsigned numDof = static_cast<unsigned>(threadStencil.numDof());
+                    for (unsigned primaryDofIdx = 0; primaryDofIdx < threadStencil.numPrimaryDof(); ++primaryDofIdx) {
+                        unsigned myIdx = threadStencil.globalSpaceIndex(primaryDofIdx);
+
+                        if (passIdx == 0) {
+                            sparsityPattern.reserveEntries(myIdx, numDof);
+                            continue;
+                        }
 
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
+                        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                            unsigned neighborIdx = threadStencil.globalSpaceIndex(dofIdx);
+                            sparsityPattern.addReservedEntry(myIdx, neighborIdx);
+                        }
+                    }
                 }
             }
+
+            if (passIdx == 0)
+                sparsityPattern.allocate();
         }
 
         // add the additional neighbors and degrees of freedom caused by the auxiliary
         // equations
         size_t numAuxMod = model.numAuxiliaryModules();
         for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+            model.auxiliaryModule(auxModIdx)->addSparsityPatternEntries(sparsityPattern);
+
+        // remove duplicate entries
+        sparsityPattern.finalize();
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
 
         // create matrix structure based on sparsity pattern
         jacobian_->reserve(sparsityPattern);
+
+        // figure out the addresses of the matrix blocks which are touched by each
+        // element
+        Stencil stencil(gridView_(), model.dofMapper());
+        model.attachStencilCache(stencil);
+        updateBlockAddresses_(stencil);
+
+        // the coloring of the elements depends on the same information as the sparsity
+        // pattern, so we update it here as well
+        if (enableColoredLinearization_)
+            elementColoring_.update(gridView_(), stencil, model.numGridDof());
+    }
+
+    // determine the addresses of all blocks of the Jacobian matrix which are modified
+    // when linearizing each element. this avoids having to look up the blocks in the
+    // rows of the sparse matrix during each linearization.
+    void updateBlockAddresses_(Stencil& stencil)
+    {
+        elementBlockOffsets_.resize(gridView_().size(/*codim=*/0));
+        blockAddresses_.clear();
+
+        ElementIterator elemIt = gridView_().template begin<0>();
+        const ElementIterator elemEndIt = gridView_().template end<0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            stencil.update(elem);
+
+            unsigned elemIdx = static_cast<unsigned>(elementMapper_().index(elem));
+            elementBlockOffsets_[elemIdx] = blockAddresses_.size();
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                unsigned globI = stencil.globalSpaceIndex(primaryDofIdx);
+                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                    unsigned globJ = stencil.globalSpaceIndex(dofIdx);
+                    blockAddresses_.push_back(jacobian_->blockAddress(globJ, globI));
+                }
+            }
+        }
     }
 
     // reset the global linear system of equations.
@@ -389,7 +521,7 @@ private:
         constraintsMap_.clear();
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        ThreadedElementIterator threadedElemIt(gridView_(), elementChunkBegins_, ThreadManager::chunkSize());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -437,6 +569,41 @@ private:
 
         applyConstraintsToSolution_();
 
+        auto linearizeFn = [this](const Element& elem) { this->linearizeElement_(elem); };
+        if (enableColoredLinearization_)
+            forEachElementColored_(linearizeFn);
+        else
+            forEachElement_(linearizeFn);
+
+        applyConstraintsToLinearization_();
+    }
+
+    // evaluate the residual of the whole system but keep the Jacobian matrix
+    void evaluateResidual_()
+    {
+        residual_ = 0.0;
+
+        applyConstraintsToSolution_();
+
+        auto evaluateFn = [this](const Element& elem) { this->evaluateElementResidual_(elem); };
+        if (enableColoredLinearization_)
+            forEachElementColored_(evaluateFn);
+        else
+            forEachElement_(evaluateFn);
+
+        if (enableConstraints_()) {
+            auto it = constraintsMap_.begin();
+            const auto& endIt = constraintsMap_.end();
+            for (; it != endIt; ++it)
+                residual_[it->first] = 0.0;
+        }
+    }
+
+    // call a function for all elements which need to be linearized using the threaded
+    // entity iterator
+    template <class ElementFn>
+    void forEachElement_(const ElementFn& elementFn)
+    {
         // to avoid a race condition if two threads handle an exception at the same time,
         // we use an explicit lock to control access to the exception storage object
         // amongst thread-local handlers
@@ -447,7 +614,7 @@ private:
         std::exception_ptr exceptionPtr = nullptr;
 
         // relinearize the elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        ThreadedElementIterator threadedElemIt(gridView_(), elementChunkBegins_, ThreadManager::chunkSize());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -473,7 +640,7 @@ private:
                     if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
                         continue;
 
-                    linearizeElement_(elem);
+                    elementFn(elem);
                 }
             }
             // If an exception occurs in the parallel block, it won't escape the
@@ -498,8 +665,49 @@ private:
         if(exceptionPtr) {
             std::rethrow_exception(exceptionPtr);
         }
+    }
 
-        applyConstraintsToLinearization_();
+    // call a function for all elements color by color. since the elements of a given
+    // color do not share any primary degree of freedom, they can be processed
+    // concurrently without locking the global linear system of equations.
+    template <class ElementFn>
+    void forEachElementColored_(const ElementFn& elementFn)
+    {
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<bool> exceptionThrown(false);
+
+        const auto& grid = gridView_().grid();
+        int chunkSize = static_cast<int>(ThreadManager::chunkSize());
+        for (unsigned colorIdx = 0; colorIdx < elementColoring_.numColors(); ++colorIdx) {
+            const auto& elementSeeds = elementColoring_.elementSeeds(colorIdx);
+            int numElements = static_cast<int>(elementSeeds.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, chunkSize)
+#endif
+            for (int i = 0; i < numElements; ++i) {
+                // once an exception has been thrown, skip all remaining elements
+                if (exceptionThrown.load(std::memory_order_relaxed))
+                    continue;
+
+                try {
+                    const auto& elem = grid.entity(elementSeeds[static_cast<size_t>(i)]);
+                    if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+
+                    elementFn(elem);
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                    exceptionThrown = true;
+                }
+            }
+
+            if (exceptionPtr)
+                std::rethrow_exception(exceptionPtr);
+        }
     }
 
     // linearize an element in the interior of the process' grid partition
@@ -513,11 +721,19 @@ private:
         // the actual work of linearization is done by the local linearizer class
         localLinearizer.linearize(*elementCtx, elem);
 
-        // update the right hand side and the Jacobian matrix
-        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+        // update the right hand side and the Jacobian matrix. if the elements are
+        // linearized color by color, no other thread can touch the same entries.
+        bool useLock = GET_PROP_VALUE(TypeTag, UseLinearizationLock) && !enableColoredLinearization_;
+        if (useLock)
             globalMatrixMutex_.lock();
 
+        // the addresses of the matrix blocks touched by the element are ordered the same
+        // way as the degrees of freedom of the element's stencil
+        unsigned elemIdx = static_cast<unsigned>(elementMapper_().index(elem));
+        MatrixBlock* const* elemBlockAddresses = blockAddresses_.data() + elementBlockOffsets_[elemIdx];
+
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+        size_t numDof = elementCtx->numDof(/*timeIdx=*/0);
         for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
             unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
 
@@ -525,14 +741,40 @@ private:
             residual_[globI] += localLinearizer.residual(primaryDofIdx);
 
             // update the global Jacobian matrix
-            for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
-                unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx)
+                *elemBlockAddresses[primaryDofIdx*numDof + dofIdx] +=
+                    localLinearizer.jacobian(dofIdx, primaryDofIdx);
+        }
 
-                jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
-            }
+        if (useLock)
+            globalMatrixMutex_.unlock();
+    }
+
+    // add the residual of an element to the global one without assembling the
+    // Jacobian matrix.
+    void evaluateElementResidual_(const Element& elem)
+    {
+        unsigned threadId = ThreadManager::threadId();
+
+        ElementContext *elementCtx = elementCtx_[threadId];
+        auto& localLinearizer = model_().localLinearizer(threadId);
+
+        // only the residual is required. the finite difference linearizer can thus skip
+        // the numeric differentiation while the automatic differentiation one still
+        // computes the derivatives for the first degree of freedom of the stencil.
+        localLinearizer.evalResidual(*elementCtx, elem);
+
+        bool useLock = GET_PROP_VALUE(TypeTag, UseLinearizationLock) && !enableColoredLinearization_;
+        if (useLock)
+            globalMatrixMutex_.lock();
+
+        size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            residual_[globI] += localLinearizer.residual(primaryDofIdx);
         }
 
-        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+        if (useLock)
             globalMatrixMutex_.unlock();
     }
 
@@ -592,6 +834,18 @@ private:
     // the right-hand side
     GlobalEqVector residual_;
 
+    // the addresses of the blocks of the Jacobian matrix which are touched by the
+    // elements and the offset of the first block of each element in this vector
+    std::vector<MatrixBlock*> blockAddresses_;
+    std::vector<size_t> elementBlockOffsets_;
+
+    // the iterators pointing to the first element of each chunk of the threaded
+    // element loops
+    typename ThreadedElementIterator::ChunkBeginVector elementChunkBegins_;
+
+    // the sets of elements which can be linearized concurrently
+    ElementColoring<GridView> elementColoring_;
+    bool enableColoredLinearization_;
 
     std::mutex globalMatrixMutex_;
 };
@@ -136,13 +136,9 @@ protected:
         ParentType::update_(nextSolution, currentSolution, solutionUpdate, currentResidual);
 
         // make sure that the intensive quantities get recalculated at the next
-        // linearization
-        if (model_().storeIntensiveQuantities()) {
-            for (unsigned dofIdx = 0; dofIdx < model_().numGridDof(); ++dofIdx)
-                model_().setIntensiveQuantitiesCacheEntryValidity(dofIdx,
-                                                                  /*timeIdx=*/0,
-                                                                  /*valid=*/false);
-        }
+        // linearization. since all grid DOFs have been updated, the whole cache is
+        // invalidated at once instead of flagging each of its entries individually.
+        model_().invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
     }
 
     /*!
@@ -33,6 +33,7 @@
 #include <opm/models/io/vtkmultiwriter.hh>
 #include <opm/models/io/restart.hh>
 #include <opm/models/discretization/common/restrictprolong.hh>
+#include <opm/models/utils/timestepcontrol.hh>
 
 #include <opm/material/common/Unused.hpp>
 #include <opm/material/common/Exceptions.hpp>
@@ -41,6 +42,8 @@
 
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <stdexcept>
 #include <string>
 
 #include <sys/stat.h>
@@ -122,6 +125,7 @@ public:
         , boundingBoxMax_(-std::numeric_limits<double>::max())
         , simulator_(simulator)
         , defaultVtkWriter_(0)
+        , controlledTimeStepSize_(0.0)
     {
         // calculate the bounding box of the local partition of the grid view
         VertexIterator vIt = gridView_.template begin<dim>();
@@ -157,6 +161,8 @@ public:
             defaultVtkWriter_ =
                 new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name());
         }
+
+        timeStepControl_ = createTimeStepControl_();
     }
 
     ~FvBaseProblem()
@@ -182,6 +188,36 @@ public:
                              "Continue with a non-converged solution instead of giving up "
                              "if we encounter a time step size smaller than the minimum time "
                              "step size.");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, TimeStepControl,
+                             "The strategy used to determine the size of the time steps. "
+                             "Possible values: 'newton', 'iteration-count', 'pid'");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, TimeStepControlRememberFailures,
+                             "Limit the size of the time steps in the time intervals where "
+                             "recent time steps have failed");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlFailureMemory,
+                             "The time span after a failed time step during which the growth "
+                             "of the time step size is limited, as a multiple of the size of "
+                             "the failed time step");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlFailureMaxGrowth,
+                             "The maximum factor by which the time step size may grow per "
+                             "time step shortly after a failed time step");
+        EWOMS_REGISTER_PARAM(TypeTag, int, TimeStepControlTargetIterations,
+                             "The number of Newton iterations targeted by the "
+                             "'iteration-count' time step controller");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlDecayRate,
+                             "The factor by which the 'iteration-count' time step controller "
+                             "shrinks the time step size");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlGrowthRate,
+                             "The factor by which the 'iteration-count' time step controller "
+                             "grows the time step size");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlTolerance,
+                             "The maximum weighted change of the primary variables over a "
+                             "time step targeted by the 'pid' time step controller");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth,
+                             "The maximum factor by which the 'pid' time step controller "
+                             "grows the time step size");
+        EWOMS_REGISTER_PARAM(TypeTag, int, TimeStepControlVerbosity,
+                             "Print the decisions of the time step controller");
     }
 
     /*!
@@ -516,14 +552,26 @@ public:
         unsigned maxFails = asImp_().maxTimeIntegrationFailures();
         Scalar minTimeStepSize = asImp_().minTimeStepSize();
 
+        controlledTimeStepSize_ = 0.0;
+
         std::string errorMessage;
         for (unsigned i = 0; i < maxFails; ++i) {
             bool converged = model().update();
-            if (converged)
+            if (converged) {
+                controlledTimeStepSize_ =
+                    timeStepControl_->nextTimeStepSize(timeStepInfo_(/*succeeded=*/true));
+                if (EWOMS_GET_PARAM(TypeTag, int, TimeStepControlVerbosity) > 0
+                    && gridView().comm().rank() == 0)
+                    std::cout << "Time step control (" << timeStepControl_->name() << "): "
+                              << "failed attempts=" << i
+                              << ", Newton iterations=" << newtonMethod().numIterations()
+                              << ", suggested next step size=" << controlledTimeStepSize_
+                              << " seconds\n" << std::flush;
                 return;
+            }
 
             Scalar dt = simulator().timeStepSize();
-            Scalar nextDt = dt / 2.0;
+            Scalar nextDt = timeStepControl_->retryTimeStepSize(timeStepInfo_(/*succeeded=*/false));
             if (dt < minTimeStepSize*(1 + 1e-9)) {
                 if (asImp_().continueOnConvergenceError()) {
                     if (gridView().comm().rank() == 0)
@@ -562,14 +610,14 @@ public:
      * \brief Returns the minimum allowable size of a time step.
      */
     Scalar minTimeStepSize() const
-    { return EWOMS_GET_PARAM(TypeTag, Scalar, MinTimeStepSize); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, MinTimeStepSize); }
 
     /*!
      * \brief Returns the maximum number of subsequent failures for the time integration
      *        before giving up.
      */
     unsigned maxTimeIntegrationFailures() const
-    { return EWOMS_GET_PARAM(TypeTag, unsigned, MaxTimeStepDivisions); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, unsigned, MaxTimeStepDivisions); }
 
     /*!
      * \brief Returns if we should continue with a non-converged solution instead of
@@ -577,7 +625,7 @@ public:
      *        step size.
      */
     bool continueOnConvergenceError() const
-    { return EWOMS_GET_PARAM(TypeTag, unsigned, ContinueOnConvergenceError); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, bool, ContinueOnConvergenceError); }
 
     /*!
      * \brief Impose the next time step size to be used externally.
@@ -595,8 +643,14 @@ public:
         if (nextTimeStepSize_ > 0.0)
             return nextTimeStepSize_;
 
-        Scalar dtNext = std::min(EWOMS_GET_PARAM(TypeTag, Scalar, MaxTimeStepSize),
-                                 newtonMethod().suggestTimeStepSize(simulator().timeStepSize()));
+        // if the time integration was not done by timeIntegration(), the time step
+        // controller was not consulted
+        Scalar dtSuggested = controlledTimeStepSize_;
+        if (dtSuggested <= 0.0)
+            dtSuggested = newtonMethod().suggestTimeStepSize(simulator().timeStepSize());
+
+        Scalar dtNext = std::min(EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, MaxTimeStepSize),
+                                 dtSuggested);
 
         if (dtNext < simulator().maxTimeStepSize()
             && simulator().maxTimeStepSize() < dtNext*2)
@@ -816,6 +870,77 @@ private:
     bool enableVtkOutput_() const
     { return EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput); }
 
+    std::unique_ptr<TimeStepControlInterface<Scalar> > createTimeStepControl_()
+    {
+        std::unique_ptr<TimeStepControlInterface<Scalar> > control;
+
+        const std::string& type = EWOMS_GET_PARAM(TypeTag, std::string, TimeStepControl);
+        if (type == "newton") {
+            auto suggestFn = [this](Scalar dt) { return this->newtonMethod().suggestTimeStepSize(dt); };
+            control.reset(new DelegatingTimeStepControl<Scalar>("newton", suggestFn));
+        }
+        else if (type == "iteration-count")
+            control.reset(new IterationCountTimeStepControl<Scalar>(EWOMS_GET_PARAM(TypeTag, int, TimeStepControlTargetIterations),
+                                                                    EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlDecayRate),
+                                                                    EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlGrowthRate)));
+        else if (type == "pid")
+            control.reset(new PidTimeStepControl<Scalar>(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlTolerance),
+                                                         EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth)));
+        else
+            throw std::invalid_argument("Unknown time step control '"+type+"'");
+
+        if (EWOMS_GET_PARAM(TypeTag, bool, TimeStepControlRememberFailures))
+            control.reset(new FailureAwareTimeStepControl<Scalar>(std::move(control),
+                                                                  EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlFailureMemory),
+                                                                  EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlFailureMaxGrowth)));
+
+        return control;
+    }
+
+    // collect the information about the time step which has just been attempted
+    TimeStepInfo<Scalar> timeStepInfo_(bool succeeded) const
+    {
+        TimeStepInfo<Scalar> info;
+        info.time = simulator().time();
+        info.timeStepSize = simulator().timeStepSize();
+        info.numNewtonIterations = newtonMethod().numIterations();
+        info.relativeChange = 0.0;
+        if (succeeded && timeStepControl_->requiresRelativeChange())
+            info.relativeChange = relativeSolutionChange_();
+        return info;
+    }
+
+    // returns the maximum weighted change of any primary variable between the
+    // solution of the last time step and the current solution
+    Scalar relativeSolutionChange_() const
+    {
+        const auto& uOld = model().solution(/*timeIdx=*/1);
+        const auto& uNew = model().solution(/*timeIdx=*/0);
+
+        Scalar result = 0.0;
+        const long numGridDof = static_cast<long>(model().numGridDof());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar threadResult = 0.0;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (long dofIdx = 0; dofIdx < numGridDof; ++dofIdx)
+                threadResult = std::max(threadResult,
+                                        model().relativeDofError(dofIdx, uOld[dofIdx], uNew[dofIdx]));
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            result = std::max(result, threadResult);
+        }
+
+        return gridView().comm().max(result);
+    }
+
     //! Returns the implementation of the problem (i.e. static polymorphism)
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -834,6 +959,9 @@ private:
     // Attributes required for the actual simulation
     Simulator& simulator_;
     mutable VtkMultiWriter *defaultVtkWriter_;
+
+    std::unique_ptr<TimeStepControlInterface<Scalar> > timeStepControl_;
+    Scalar controlledTimeStepSize_;
 };
 
 } // namespace Opm
@@ -80,6 +80,12 @@ NEW_PROP_TAG(GridView);
 //! The class describing the stencil of the spatial discretization
 NEW_PROP_TAG(Stencil);
 
+//! Specify whether the finite volume geometry of all elements should be computed once
+//! and then be kept in memory instead of computing it whenever the stencil of an element
+//! is updated. (this is currently only considered by the element centered finite volume
+//! discretization.)
+NEW_PROP_TAG(EnableStencilCache);
+
 //! The class describing the discrete function space when dune-fem is used, otherwise it points to the stencil class
 NEW_PROP_TAG(DiscreteFunctionSpace);
 
@@ -162,12 +168,21 @@ NEW_PROP_TAG(GridCommHandleFactory);
 NEW_PROP_TAG(ThreadManager);
 NEW_PROP_TAG(ThreadsPerProcess);
 
+//! The number of consecutive grid entities which are handed to a thread at once by
+//! threaded loops over the grid
+NEW_PROP_TAG(ThreadedLoopChunkSize);
+
 //! use locking to prevent race conditions when linearizing the global system of
 //! equations in multi-threaded mode. (setting this property to true is always save, but
 //! it may slightly deter performance in multi-threaded simlations and some
 //! discretizations do not need this.)
 NEW_PROP_TAG(UseLinearizationLock);
 
+//! Linearize the elements in sets ("colors") which do not share any primary degree of
+//! freedom. This allows to assemble the global system of equations in multi-threaded
+//! mode without any locking.
+NEW_PROP_TAG(EnableColoredLinearization);
+
 // high-level simulation control
 
 //! Manages the simulation time
@@ -246,6 +261,69 @@ NEW_PROP_TAG(MaxTimeStepDivisions);
  */
 NEW_PROP_TAG(ContinueOnConvergenceError);
 
+/*!
+ * \brief The strategy used to determine the size of the time steps.
+ *
+ * Possible values are "newton" (ask the Newton method), "iteration-count" and "pid"
+ * (control the relative change of the primary variables).
+ */
+NEW_PROP_TAG(TimeStepControl);
+
+/*!
+ * \brief Specify whether the time step controller remembers where the most recent
+ *        time step failures happened.
+ */
+NEW_PROP_TAG(TimeStepControlRememberFailures);
+
+/*!
+ * \brief The time span after a failed time step during which the time step controller
+ *        limits the growth of the time step size.
+ *
+ * This is specified as a multiple of the size of the failed time step.
+ */
+NEW_PROP_TAG(TimeStepControlFailureMemory);
+
+/*!
+ * \brief The maximum factor by which the time step size may grow per time step shortly
+ *        after a failed time step.
+ */
+NEW_PROP_TAG(TimeStepControlFailureMaxGrowth);
+
+/*!
+ * \brief The number of Newton iterations targeted by the "iteration-count" time step
+ *        controller.
+ */
+NEW_PROP_TAG(TimeStepControlTargetIterations);
+
+/*!
+ * \brief The factor by which the "iteration-count" time step controller shrinks the
+ *        time step size.
+ */
+NEW_PROP_TAG(TimeStepControlDecayRate);
+
+/*!
+ * \brief The factor by which the "iteration-count" time step controller grows the
+ *        time step size.
+ */
+NEW_PROP_TAG(TimeStepControlGrowthRate);
+
+/*!
+ * \brief The maximum weighted change of the primary variables over a time step which
+ *        is targeted by the "pid" time step controller.
+ */
+NEW_PROP_TAG(TimeStepControlTolerance);
+
+/*!
+ * \brief The maximum factor by which the "pid" time step controller grows the time
+ *        step size.
+ */
+NEW_PROP_TAG(TimeStepControlMaxGrowth);
+
+/*!
+ * \brief Specify whether the time step controller reports its decisions.
+ */
+NEW_PROP_TAG(TimeStepControlVerbosity);
+
 /*!
  * \brief Specify whether all intensive quantities for the grid should be
  *        cached in the discretization.
@@ -265,6 +343,17 @@ NEW_PROP_TAG(EnableIntensiveQuantityCache);
  */
 NEW_PROP_TAG(EnableStorageCache);
 
+/*!
+ * \brief Specify whether the cached intensive quantities of the initial solution of a
+ *        time step are kept for retrying the time step if it fails.
+ *
+ * This only has an effect if the storage term and the intensive quantities are
+ * cached. It avoids recalculating the intensive quantities of all degrees of freedom
+ * after a failed time step, but requires memory for a second set of cached intensive
+ * quantities.
+ */
+NEW_PROP_TAG(EnableIntensiveQuantityCheckpoint);
+
 /*!
  * \brief Specify whether to use the already calculated solutions as
  *        starting values of the intensive quantities.
@@ -131,6 +131,10 @@ class EcfvDiscretization : public FvBaseDiscretization<TypeTag>
     typedef typename GET_PROP_TYPE(TypeTag, SolutionVector) SolutionVector;
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, Stencil) Stencil;
+    typedef typename Stencil::StencilCache StencilCache;
+
+    enum { enableStencilCache = GET_PROP_VALUE(TypeTag, EnableStencilCache) };
 
 public:
     EcfvDiscretization(Simulator& simulator)
@@ -156,6 +160,27 @@ public:
     const DofMapper& dofMapper() const
     { return this->elementMapper(); }
 
+    /*!
+     * \copydoc FvBaseDiscretization::updateStencilCache()
+     *
+     * If the EnableStencilCache property is set, the finite volume geometry of all
+     * elements is computed here and then looked up by the stencils.
+     */
+    void updateStencilCache()
+    {
+        if (enableStencilCache)
+            stencilCache_.update(this->gridView_, this->elementMapper());
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::attachStencilCache()
+     */
+    void attachStencilCache(Stencil& stencil) const
+    {
+        if (enableStencilCache)
+            stencil.setCache(&stencilCache_);
+    }
+
     /*!
      * \brief Syncronize the values of the primary variables on the
      *        degrees of freedom that overlap with the neighboring
@@ -210,6 +235,10 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    // the finite volume geometry of all elements (only used if the EnableStencilCache
+    // property is set)
+    StencilCache stencilCache_;
 };
 } // namespace Opm
 
@@ -28,6 +28,8 @@
 #ifndef EWOMS_ECFV_STENCIL_HH
 #define EWOMS_ECFV_STENCIL_HH
 
+#include "ecfvstencilcache.hh"
+
 #include <opm/models/utils/quadraturegeometries.hh>
 
 #include <opm/material/common/ConditionalStorage.hpp>
@@ -77,6 +79,8 @@ public:
     typedef Element        Entity;
     typedef ElementMapper  Mapper;
 
+    typedef EcfvStencilCache<Scalar, GridView, needFaceIntegrationPos, needFaceNormal> StencilCache;
+
     typedef typename Element::Geometry LocalGeometry;
 
     /*!
@@ -99,6 +103,12 @@ public:
             : element_(element)
         { update(); }
 
+        SubControlVolume(const Element& element, const GlobalPosition& centerPos, Scalar volume)
+            : centerPos_(centerPos)
+            , volume_(volume)
+            , element_(element)
+        { }
+
         void update(const Element& element)
         { element_ = element; }
 
@@ -168,6 +178,20 @@ public:
             area_ = geometry.volume();
         }
 
+        EcfvSubControlVolumeFace(unsigned localNeighborIdx,
+                                 Scalar area,
+                                 const WorldVector* normal,
+                                 const GlobalPosition* integrationPos)
+        {
+            exteriorIdx_ = static_cast<unsigned short>(localNeighborIdx);
+
+            if (needNormal)
+                (*normal_) = *normal;
+            if (needIntegrationPos)
+                (*integrationPos_) = *integrationPos;
+            area_ = area;
+        }
+
         /*!
          * \brief Returns the local index of the degree of freedom to
          *        the face's interior.
@@ -223,13 +247,29 @@ public:
     EcfvStencil(const GridView& gridView, const Mapper& mapper)
         : gridView_(gridView)
         , elementMapper_(mapper)
+        , cache_(nullptr)
     {
         // try to ensure that the mapper passed indeed maps elements
         assert(int(gridView.size(/*codim=*/0)) == int(elementMapper_.size()));
     }
 
+    /*!
+     * \brief Use the finite volume geometry which is stored by a stencil cache.
+     *
+     * If a valid cache is set, the stencil looks up the geometry of the elements and
+     * their faces instead of computing it from the grid. Passing a null pointer makes
+     * the stencil compute everything from scratch again.
+     */
+    void setCache(const StencilCache* cache)
+    { cache_ = cache; }
+
     void updateTopology(const Element& element)
     {
+        if (cache_ && cache_->isValid()) {
+            updateTopologyFromCache_(element);
+            return;
+        }
+
         auto isIt = gridView_.ibegin(element);
         const auto& endIsIt = gridView_.iend(element);
 
@@ -262,7 +302,14 @@ public:
     {
         // add the "center" element of the stencil
         subControlVolumes_.clear();
-        subControlVolumes_.emplace_back(/*SubControlVolume(*/element/*)*/);
+        if (cache_ && cache_->isValid()) {
+            unsigned elemIdx = static_cast<unsigned>(elementMapper_.index(element));
+            subControlVolumes_.emplace_back(element,
+                                            cache_->elementCenter(elemIdx),
+                                            cache_->elementVolume(elemIdx));
+        }
+        else
+            subControlVolumes_.emplace_back(/*SubControlVolume(*/element/*)*/);
         elements_.clear();
         elements_.emplace_back(element);
     }
@@ -383,8 +430,49 @@ public:
     { return boundaryFaces_[bfIdx]; }
 
 protected:
+    void updateTopologyFromCache_(const Element& element)
+    {
+        const auto& grid = gridView_.grid();
+        unsigned elemIdx = static_cast<unsigned>(elementMapper_.index(element));
+
+        // add the "center" element of the stencil
+        subControlVolumes_.clear();
+        subControlVolumes_.emplace_back(element,
+                                        cache_->elementCenter(elemIdx),
+                                        cache_->elementVolume(elemIdx));
+        elements_.clear();
+        elements_.emplace_back(element);
+
+        interiorFaces_.clear();
+        boundaryFaces_.clear();
+
+        // add the neighbors and the interior faces. the faces are stored in the same
+        // order by the cache as they are visited by the intersection iterator.
+        unsigned faceEndIdx = cache_->interiorFaceEnd(elemIdx);
+        for (unsigned faceIdx = cache_->interiorFaceBegin(elemIdx); faceIdx < faceEndIdx; ++faceIdx) {
+            unsigned neighborIdx = cache_->neighborIndex(faceIdx);
+            elements_.emplace_back(grid.entity(cache_->elementSeed(neighborIdx)));
+            subControlVolumes_.emplace_back(elements_.back(),
+                                            cache_->elementCenter(neighborIdx),
+                                            cache_->elementVolume(neighborIdx));
+            interiorFaces_.emplace_back(subControlVolumes_.size() - 1,
+                                        cache_->interiorFaceArea(faceIdx),
+                                        cache_->interiorFaceNormal(faceIdx),
+                                        cache_->interiorFaceIntegrationPos(faceIdx));
+        }
+
+        // add the boundary faces
+        faceEndIdx = cache_->boundaryFaceEnd(elemIdx);
+        for (unsigned faceIdx = cache_->boundaryFaceBegin(elemIdx); faceIdx < faceEndIdx; ++faceIdx)
+            boundaryFaces_.emplace_back(/*localNeighborIdx=*/- 10000,
+                                        cache_->boundaryFaceArea(faceIdx),
+                                        cache_->boundaryFaceNormal(faceIdx),
+                                        cache_->boundaryFaceIntegrationPos(faceIdx));
+    }
+
     const GridView&       gridView_;
     const ElementMapper&  elementMapper_;
+    const StencilCache*   cache_;
 
     std::vector<Element> elements_;
     std::vector<SubControlVolume>      subControlVolumes_;
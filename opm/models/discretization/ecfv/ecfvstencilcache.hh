@@ -0,0 +1,336 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::EcfvStencilCache
+ */
+#ifndef EWOMS_ECFV_STENCIL_CACHE_HH
+#define EWOMS_ECFV_STENCIL_CACHE_HH
+
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/version.hh>
+
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup EcfvDiscretization
+ *
+ * \brief Stores the topology and the geometry of the stencils of all elements of a grid
+ *        view for the ECFV discretization.
+ *
+ * Computing the finite volume geometry of an element requires to iterate over its
+ * intersections and to evaluate the geometries of the element, of its neighbors and of
+ * the intersections. Since this does not change as long as the grid is not modified,
+ * these quantities can be computed once and then be looked up by the stencils. The data
+ * is stored in a "structure of arrays" fashion: The quantities of the elements are
+ * indexed by the element index and the quantities of the faces of an element are
+ * located in the range given by the face offsets of the element.
+ */
+template <class Scalar,
+          class GridView,
+          bool needFaceIntegrationPos = true,
+          bool needFaceNormal = true>
+class EcfvStencilCache
+{
+    enum { dimWorld = GridView::dimensionworld };
+
+    typedef typename GridView::ctype CoordScalar;
+    typedef typename GridView::template Codim<0>::Entity Element;
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename Element::EntitySeed ElementSeed;
+
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
+    typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> ElementMapper;
+#else
+    typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView, Dune::MCMGElementLayout> ElementMapper;
+#endif
+
+    typedef Dune::FieldVector<CoordScalar, dimWorld> GlobalPosition;
+    typedef Dune::FieldVector<Scalar, dimWorld> WorldVector;
+
+public:
+    EcfvStencilCache()
+    { }
+
+    /*!
+     * \brief Compute the finite volume geometry of all elements of a grid view.
+     *
+     * This method must be called every time the grid has been changed.
+     *
+     * \param gridView The grid view for which the geometry ought to be cached
+     * \param elementMapper The mapper which determines the indices of the elements
+     */
+    void update(const GridView& gridView, const ElementMapper& elementMapper)
+    {
+        clear();
+
+        size_t numElements = static_cast<size_t>(gridView.size(/*codim=*/0));
+        elementSeeds_.resize(numElements);
+        elementCenters_.resize(numElements);
+        elementVolumes_.resize(numElements);
+        interiorFaceOffsets_.resize(numElements + 1);
+        boundaryFaceOffsets_.resize(numElements + 1);
+
+        // the element with index 'i' is not necessarily the i-th element visited by the
+        // iterator, so the faces are first stored in the order of the iteration and the
+        // offsets are fixed afterwards.
+        std::vector<unsigned> iterationOrder;
+        iterationOrder.reserve(numElements);
+        std::vector<unsigned> numInteriorFaces(numElements, 0);
+        std::vector<unsigned> numBoundaryFaces(numElements, 0);
+
+        std::vector<unsigned> tmpNeighborIndices;
+        std::vector<Scalar> tmpInteriorFaceAreas;
+        std::vector<WorldVector> tmpInteriorFaceNormals;
+        std::vector<GlobalPosition> tmpInteriorFaceIntegrationPos;
+        std::vector<Scalar> tmpBoundaryFaceAreas;
+        std::vector<WorldVector> tmpBoundaryFaceNormals;
+        std::vector<GlobalPosition> tmpBoundaryFaceIntegrationPos;
+
+        ElementIterator elemIt = gridView.template begin</*codim=*/0>();
+        const ElementIterator elemEndIt = gridView.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+            iterationOrder.push_back(elemIdx);
+
+            const auto& elemGeometry = elem.geometry();
+            elementSeeds_[elemIdx] = elem.seed();
+            elementCenters_[elemIdx] = elemGeometry.center();
+            elementVolumes_[elemIdx] = elemGeometry.volume();
+
+            auto isIt = gridView.ibegin(elem);
+            const auto& isEndIt = gridView.iend(elem);
+            for (; isIt != isEndIt; ++isIt) {
+                const auto& intersection = *isIt;
+                const auto& isGeometry = intersection.geometry();
+                if (intersection.neighbor()) {
+                    ++numInteriorFaces[elemIdx];
+                    tmpNeighborIndices.push_back(static_cast<unsigned>(elementMapper.index(intersection.outside())));
+                    tmpInteriorFaceAreas.push_back(isGeometry.volume());
+                    if (needFaceNormal)
+                        tmpInteriorFaceNormals.push_back(intersection.centerUnitOuterNormal());
+                    if (needFaceIntegrationPos)
+                        tmpInteriorFaceIntegrationPos.push_back(isGeometry.center());
+                }
+                else {
+                    ++numBoundaryFaces[elemIdx];
+                    tmpBoundaryFaceAreas.push_back(isGeometry.volume());
+                    if (needFaceNormal)
+                        tmpBoundaryFaceNormals.push_back(intersection.centerUnitOuterNormal());
+                    tmpBoundaryFaceIntegrationPos.push_back(isGeometry.center());
+                }
+            }
+        }
+
+        // compute the offsets of the faces of each element
+        interiorFaceOffsets_[0] = 0;
+        boundaryFaceOffsets_[0] = 0;
+        for (unsigned elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+            interiorFaceOffsets_[elemIdx + 1] = interiorFaceOffsets_[elemIdx] + numInteriorFaces[elemIdx];
+            boundaryFaceOffsets_[elemIdx + 1] = boundaryFaceOffsets_[elemIdx] + numBoundaryFaces[elemIdx];
+        }
+
+        // move the faces to their final positions
+        neighborIndices_.resize(tmpNeighborIndices.size());
+        interiorFaceAreas_.resize(tmpInteriorFaceAreas.size());
+        interiorFaceNormals_.resize(tmpInteriorFaceNormals.size());
+        interiorFaceIntegrationPos_.resize(tmpInteriorFaceIntegrationPos.size());
+        boundaryFaceAreas_.resize(tmpBoundaryFaceAreas.size());
+        boundaryFaceNormals_.resize(tmpBoundaryFaceNormals.size());
+        boundaryFaceIntegrationPos_.resize(tmpBoundaryFaceIntegrationPos.size());
+
+        unsigned srcInteriorFaceIdx = 0;
+        unsigned srcBoundaryFaceIdx = 0;
+        for (unsigned elemIdx : iterationOrder) {
+            for (unsigned faceIdx = interiorFaceOffsets_[elemIdx];
+                 faceIdx < interiorFaceOffsets_[elemIdx + 1];
+                 ++faceIdx, ++srcInteriorFaceIdx)
+            {
+                neighborIndices_[faceIdx] = tmpNeighborIndices[srcInteriorFaceIdx];
+                interiorFaceAreas_[faceIdx] = tmpInteriorFaceAreas[srcInteriorFaceIdx];
+                if (needFaceNormal)
+                    interiorFaceNormals_[faceIdx] = tmpInteriorFaceNormals[srcInteriorFaceIdx];
+                if (needFaceIntegrationPos)
+                    interiorFaceIntegrationPos_[faceIdx] = tmpInteriorFaceIntegrationPos[srcInteriorFaceIdx];
+            }
+
+            for (unsigned faceIdx = boundaryFaceOffsets_[elemIdx];
+                 faceIdx < boundaryFaceOffsets_[elemIdx + 1];
+                 ++faceIdx, ++srcBoundaryFaceIdx)
+            {
+                boundaryFaceAreas_[faceIdx] = tmpBoundaryFaceAreas[srcBoundaryFaceIdx];
+                if (needFaceNormal)
+                    boundaryFaceNormals_[faceIdx] = tmpBoundaryFaceNormals[srcBoundaryFaceIdx];
+                boundaryFaceIntegrationPos_[faceIdx] = tmpBoundaryFaceIntegrationPos[srcBoundaryFaceIdx];
+            }
+        }
+    }
+
+    /*!
+     * \brief Discard all cached data.
+     */
+    void clear()
+    {
+        elementSeeds_.clear();
+        elementCenters_.clear();
+        elementVolumes_.clear();
+        interiorFaceOffsets_.clear();
+        neighborIndices_.clear();
+        interiorFaceAreas_.clear();
+        interiorFaceNormals_.clear();
+        interiorFaceIntegrationPos_.clear();
+        boundaryFaceOffsets_.clear();
+        boundaryFaceAreas_.clear();
+        boundaryFaceNormals_.clear();
+        boundaryFaceIntegrationPos_.clear();
+    }
+
+    /*!
+     * \brief Returns true iff the cache contains the geometry of a grid.
+     */
+    bool isValid() const
+    { return !elementVolumes_.empty(); }
+
+    /*!
+     * \brief Returns the number of elements for which the geometry is cached.
+     */
+    size_t numElements() const
+    { return elementVolumes_.size(); }
+
+    /*!
+     * \brief Returns the seed of an element.
+     */
+    const ElementSeed& elementSeed(unsigned elemIdx) const
+    { return elementSeeds_[elemIdx]; }
+
+    /*!
+     * \brief Returns the center of an element.
+     */
+    const GlobalPosition& elementCenter(unsigned elemIdx) const
+    { return elementCenters_[elemIdx]; }
+
+    /*!
+     * \brief Returns the volume [m^3] of an element.
+     */
+    Scalar elementVolume(unsigned elemIdx) const
+    { return elementVolumes_[elemIdx]; }
+
+    /*!
+     * \brief Returns the index of the first interior face of an element.
+     */
+    unsigned interiorFaceBegin(unsigned elemIdx) const
+    { return interiorFaceOffsets_[elemIdx]; }
+
+    /*!
+     * \brief Returns the index after the last interior face of an element.
+     */
+    unsigned interiorFaceEnd(unsigned elemIdx) const
+    { return interiorFaceOffsets_[elemIdx + 1]; }
+
+    /*!
+     * \brief Returns the index of the element on the outside of an interior face.
+     */
+    unsigned neighborIndex(unsigned faceIdx) const
+    { return neighborIndices_[faceIdx]; }
+
+    /*!
+     * \brief Returns the area [m^2] of an interior face.
+     */
+    Scalar interiorFaceArea(unsigned faceIdx) const
+    { return interiorFaceAreas_[faceIdx]; }
+
+    /*!
+     * \brief Returns the outer unit normal of an interior face.
+     *
+     * If the normals are not cached, this method returns a null pointer.
+     */
+    const WorldVector* interiorFaceNormal(unsigned faceIdx) const
+    { return needFaceNormal ? &interiorFaceNormals_[faceIdx] : nullptr; }
+
+    /*!
+     * \brief Returns the integration point of an interior face.
+     *
+     * If the integration points are not cached, this method returns a null pointer.
+     */
+    const GlobalPosition* interiorFaceIntegrationPos(unsigned faceIdx) const
+    { return needFaceIntegrationPos ? &interiorFaceIntegrationPos_[faceIdx] : nullptr; }
+
+    /*!
+     * \brief Returns the index of the first boundary face of an element.
+     */
+    unsigned boundaryFaceBegin(unsigned elemIdx) const
+    { return boundaryFaceOffsets_[elemIdx]; }
+
+    /*!
+     * \brief Returns the index after the last boundary face of an element.
+     */
+    unsigned boundaryFaceEnd(unsigned elemIdx) const
+    { return boundaryFaceOffsets_[elemIdx + 1]; }
+
+    /*!
+     * \brief Returns the area [m^2] of a boundary face.
+     */
+    Scalar boundaryFaceArea(unsigned faceIdx) const
+    { return boundaryFaceAreas_[faceIdx]; }
+
+    /*!
+     * \brief Returns the outer unit normal of a boundary face.
+     *
+     * If the normals are not cached, this method returns a null pointer.
+     */
+    const WorldVector* boundaryFaceNormal(unsigned faceIdx) const
+    { return needFaceNormal ? &boundaryFaceNormals_[faceIdx] : nullptr; }
+
+    /*!
+     * \brief Returns the integration point of a boundary face.
+     */
+    const GlobalPosition* boundaryFaceIntegrationPos(unsigned faceIdx) const
+    { return &boundaryFaceIntegrationPos_[faceIdx]; }
+
+private:
+    // quantities of the elements
+    std::vector<ElementSeed> elementSeeds_;
+    std::vector<GlobalPosition> elementCenters_;
+    std::vector<Scalar> elementVolumes_;
+
+    // quantities of the interior faces
+    std::vector<unsigned> interiorFaceOffsets_;
+    std::vector<unsigned> neighborIndices_;
+    std::vector<Scalar> interiorFaceAreas_;
+    std::vector<WorldVector> interiorFaceNormals_;
+    std::vector<GlobalPosition> interiorFaceIntegrationPos_;
+
+    // quantities of the boundary faces
+    std::vector<unsigned> boundaryFaceOffsets_;
+    std::vector<Scalar> boundaryFaceAreas_;
+    std::vector<WorldVector> boundaryFaceNormals_;
+    std::vector<GlobalPosition> boundaryFaceIntegrationPos_;
+};
+
+} // namespace Opm
+
+#endif
@@ -81,27 +81,43 @@ protected:
         this->lastError_ = this->error_;
 
         // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
+        // the solution's residual. auxiliary DOFs are not considered for the error.
         this->error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= this->model().numGridDof() || this->model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (this->enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
-                    continue;
-            }
+        const long numGridDof = static_cast<long>(std::min<size_t>(this->model().numGridDof(),
+                                                                   currentResidual.size()));
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar threadError = 0.0;
 
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
-                if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (long dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+                if (this->model().dofTotalVolume(dofIdx) <= 0.0)
                     continue;
-                this->error_ =
-                    std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
-                             this->error_);
+
+                // also do not consider DOFs which are constraint
+                if (this->enableConstraints_()) {
+                    if (constraintsMap.count(dofIdx) > 0)
+                        continue;
+                }
+
+                const auto& r = currentResidual[dofIdx];
+                for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
+                    if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
+                        continue;
+                    threadError =
+                        std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
+                                 threadError);
+                }
             }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            this->error_ = std::max(this->error_, threadError);
         }
 
         // take the other processes into account
@@ -109,10 +125,10 @@ protected:
 
         // make sure that the error never grows beyond the maximum
         // allowed one
-        if (this->error_ > EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))
+        if (this->error_ > EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, NewtonMaxError))
             throw Opm::NumericalIssue("Newton: Error "+std::to_string(double(this->error_))+
                                         +" is larger than maximum allowed error of "
-                                        +std::to_string(double(EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))));
+                                        +std::to_string(double(EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, NewtonMaxError))));
     }
 
     /*!
@@ -44,7 +44,11 @@
 #include <dune/common/version.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 #include <unistd.h>
@@ -104,7 +108,18 @@ NEW_PROP_TAG(Linearizer);
 //! Specifies the type of a global Jacobian matrix
 NEW_PROP_TAG(SparseMatrixAdapter);
 
-//! Specifies the type of the linear solver to be used
+/*!
+ * \brief Specifies the type of the linear solver to be used
+ *
+ * For each iteration, the Newton method calls prepare(), setResidual() and
+ * getResidual() of the linear solver backend, then setMatrix() and finally solve().
+ * If the Jacobian matrix is reused (cf. NewtonEnableJacobianReuse), setMatrix() is
+ * skipped. Calling solve() without a preceding call to setMatrix() means that the
+ * matrix is the same as for the previous solve, so the backend may keep any state
+ * which it has derived from it (e.g., the preconditioner). Backends which keep a
+ * reference to the matrix instead of copying it may rely on the matrix not being
+ * modified until the next call to setMatrix().
+ */
 NEW_PROP_TAG(LinearSolverBackend);
 
 //! Specifies whether the Newton method should print messages or not
@@ -146,6 +161,21 @@ NEW_PROP_TAG(NewtonTargetIterations);
 //! Number of maximum iterations for the Newton method.
 NEW_PROP_TAG(NewtonMaxIterations);
 
+/*!
+ * \brief Specifies whether the Newton method may reuse the Jacobian matrix of the
+ *        previous iteration.
+ *
+ * If this is enabled, only the residual is evaluated for iterations which follow an
+ * iteration that reduced the error sufficiently (modified Newton method).
+ */
+NEW_PROP_TAG(NewtonEnableJacobianReuse);
+
+/*!
+ * \brief The factor by which an iteration must at least reduce the error for the
+ *        Jacobian matrix to be reused by the next iteration.
+ */
+NEW_PROP_TAG(NewtonJacobianReuseContraction);
+
 // set default values for the properties
 SET_TYPE_PROP(NewtonMethod, NewtonMethod, Opm::NewtonMethod<TypeTag>);
 SET_TYPE_PROP(NewtonMethod, NewtonConvergenceWriter, Opm::NullConvergenceWriter<TypeTag>);
@@ -157,6 +187,8 @@ SET_SCALAR_PROP(NewtonMethod, NewtonTolerance, 1e-8);
 SET_SCALAR_PROP(NewtonMethod, NewtonMaxError, 1e100);
 SET_INT_PROP(NewtonMethod, NewtonTargetIterations, 10);
 SET_INT_PROP(NewtonMethod, NewtonMaxIterations, 18);
+SET_BOOL_PROP(NewtonMethod, NewtonEnableJacobianReuse, false);
+SET_SCALAR_PROP(NewtonMethod, NewtonJacobianReuseContraction, 0.25);
 
 END_PROPERTIES
 
@@ -230,6 +262,13 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxError,
                              "The maximum error tolerated by the Newton "
                              "method to which does not cause an abort");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonEnableJacobianReuse,
+                             "Reuse the Jacobian matrix and the preconditioner of "
+                             "the previous Newton iteration if it reduced the error "
+                             "sufficiently");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonJacobianReuseContraction,
+                             "The factor by which a Newton iteration must at least "
+                             "reduce the error for its Jacobian matrix to be reused");
     }
 
     /*!
@@ -350,6 +389,11 @@ public:
             while (asImp_().proceed_()) {
                 // linearize the problem at the current solution
 
+                // decide whether the Jacobian matrix of the last iteration is
+                // reused. this needs to be done before beginIteration_() is called
+                // because it overwrites the error of the last iteration.
+                bool reuseJacobian = asImp_().reuseJacobian_();
+
                 // notify the implementation that we're about to start
                 // a new iteration
                 prePostProcessTimer_.start();
@@ -360,15 +404,22 @@ public:
                 currentSolution = nextSolution;
 
                 if (asImp_().verbose_()) {
-                    std::cout << "Linearize: r(x^k) = dS/dt + div F - q;   M = grad r"
-                              << clearRemainingLine
+                    if (reuseJacobian)
+                        std::cout << "Evaluate: r(x^k) = dS/dt + div F - q;   M = M^(k-1)";
+                    else
+                        std::cout << "Linearize: r(x^k) = dS/dt + div F - q;   M = grad r";
+                    std::cout << clearRemainingLine
                               << std::flush;
                 }
 
                 // do the actual linearization
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
-                asImp_().linearizeAuxiliaryEquations_();
+                if (reuseJacobian)
+                    asImp_().evaluateResidual_();
+                else {
+                    asImp_().linearizeDomain_();
+                    asImp_().linearizeAuxiliaryEquations_();
+                }
                 linearizeTimer_.stop();
 
                 solveTimer_.start();
@@ -408,8 +459,10 @@ public:
 
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
-                // update of the solution
-                linearSolver_.setMatrix(jacobian);
+                // update of the solution. if the Jacobian is reused, the linear solver
+                // already knows it, which allows it to keep its preconditioner.
+                if (!reuseJacobian)
+                    linearSolver_.setMatrix(jacobian);
                 solutionUpdate = 0.0;
                 bool converged = linearSolver_.solve(solutionUpdate);
                 solveTimer_.stop();
@@ -592,7 +645,7 @@ protected:
      */
     bool verbose_() const
     {
-        return EWOMS_GET_PARAM(TypeTag, bool, NewtonVerbose) && (comm_.rank() == 0);
+        return EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonVerbose) && (comm_.rank() == 0);
     }
 
     /*!
@@ -605,7 +658,7 @@ protected:
     {
         numIterations_ = 0;
 
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.beginTimeStep();
     }
 
@@ -662,30 +715,78 @@ protected:
         model().linearizer().finalize();
     }
 
+    /*!
+     * \brief Evaluate the residual of the global non-linear system of equations while
+     *        keeping the Jacobian matrix of the last linearization.
+     */
+    void evaluateResidual_()
+    {
+        model().linearizer().evaluateDomainResidual();
+    }
+
+    /*!
+     * \brief Returns true if the next iteration should reuse the Jacobian matrix of the
+     *        previous one.
+     *
+     * This is the case if the last iteration reduced the error at least by the factor
+     * given by the NewtonJacobianReuseContraction parameter. Since the error reduction
+     * of an iteration is only known once the residual of its result has been evaluated,
+     * the first two iterations of each time step always linearize the system. Also,
+     * the auxiliary modules cannot evaluate their residuals on their own, so the
+     * Jacobian is never reused if there are any.
+     */
+    bool reuseJacobian_() const
+    {
+        if (!EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonEnableJacobianReuse))
+            return false;
+
+        if (numIterations_ < 2 || model().numAuxiliaryModules() > 0)
+            return false;
+
+        Scalar contraction = EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, NewtonJacobianReuseContraction);
+        return error_ <= contraction*lastError_;
+    }
+
     void preSolve_(const SolutionVector& currentSolution  OPM_UNUSED,
                    const GlobalEqVector& currentResidual)
     {
         const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
-        Scalar newtonMaxError = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError);
+        Scalar newtonMaxError = EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, NewtonMaxError);
 
         // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
+        // the solution's residual. auxiliary DOFs are not considered for the error.
         error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
+        const long numGridDof = static_cast<long>(std::min<size_t>(model().numGridDof(),
+                                                                   currentResidual.size()));
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar threadError = 0.0;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (long dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+                if (model().dofTotalVolume(dofIdx) <= 0.0)
                     continue;
+
+                // also do not consider DOFs which are constraint
+                if (enableConstraints_()) {
+                    if (constraintsMap.count(dofIdx) > 0)
+                        continue;
+                }
+
+                const auto& r = currentResidual[dofIdx];
+                for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
+                    threadError = Opm::max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), threadError);
             }
 
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = Opm::max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            error_ = Opm::max(error_, threadError);
         }
 
         // take the other processes into account
@@ -776,40 +877,80 @@ protected:
         // analysis possible
         asImp_().writeConvergence_(currentSolution, solutionUpdate);
 
-        // make sure not to swallow non-finite values at this point
-        if (!std::isfinite(solutionUpdate.one_norm()))
-            throw Opm::NumericalIssue("Non-finite update!");
+        // the degrees of freedom are updated independently of each other, so the work
+        // can be distributed over the threads. exceptions cannot leave the threaded
+        // loop, so the first one is stored and re-thrown afterwards.
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        bool finiteUpdate = true;
+
+        const long numGridDof = static_cast<long>(model().numGridDof());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            bool threadFiniteUpdate = true;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (long dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+                // make sure not to swallow non-finite values at this point
+                if (!isFinite_(solutionUpdate[dofIdx])) {
+                    threadFiniteUpdate = false;
+                    continue;
+                }
 
-        size_t numGridDof = model().numGridDof();
-        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0) {
-                    const auto& constraints = constraintsMap.at(dofIdx);
-                    asImp_().updateConstraintDof_(dofIdx,
-                                                  nextSolution[dofIdx],
-                                                  constraints);
+                try {
+                    if (enableConstraints_() && constraintsMap.count(dofIdx) > 0) {
+                        const auto& constraints = constraintsMap.at(dofIdx);
+                        asImp_().updateConstraintDof_(dofIdx,
+                                                      nextSolution[dofIdx],
+                                                      constraints);
+                    }
+                    else
+                        asImp_().updatePrimaryVariables_(dofIdx,
+                                                         nextSolution[dofIdx],
+                                                         currentSolution[dofIdx],
+                                                         solutionUpdate[dofIdx],
+                                                         currentResidual[dofIdx]);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    if (!exceptionPtr)
+                        exceptionPtr = std::current_exception();
                 }
-                else
-                    asImp_().updatePrimaryVariables_(dofIdx,
-                                                     nextSolution[dofIdx],
-                                                     currentSolution[dofIdx],
-                                                     solutionUpdate[dofIdx],
-                                                     currentResidual[dofIdx]);
             }
-            else
-                asImp_().updatePrimaryVariables_(dofIdx,
-                                                 nextSolution[dofIdx],
-                                                 currentSolution[dofIdx],
-                                                 solutionUpdate[dofIdx],
-                                                 currentResidual[dofIdx]);
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            finiteUpdate = finiteUpdate && threadFiniteUpdate;
         }
 
         // update the DOFs of the auxiliary equations
         size_t numDof = model().numTotalDof();
-        for (size_t dofIdx = numGridDof; dofIdx < numDof; ++dofIdx) {
+        for (size_t dofIdx = static_cast<size_t>(numGridDof); dofIdx < numDof; ++dofIdx) {
+            finiteUpdate = finiteUpdate && isFinite_(solutionUpdate[dofIdx]);
+
             nextSolution[dofIdx] = currentSolution[dofIdx];
             nextSolution[dofIdx] -= solutionUpdate[dofIdx];
         }
+
+        if (!finiteUpdate)
+            throw Opm::NumericalIssue("Non-finite update!");
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    template <class Block>
+    static bool isFinite_(const Block& block)
+    {
+        for (unsigned i = 0; i < block.size(); ++i)
+            if (!std::isfinite(block[i]))
+                return false;
+        return true;
     }
 
     /*!
@@ -822,6 +963,9 @@ protected:
 
     /*!
      * \brief Update a single primary variables object.
+     *
+     * This method may be called concurrently by multiple threads for different degrees
+     * of freedom, i.e., it must not modify any state which is shared between them.
      */
     void updatePrimaryVariables_(unsigned globalDofIdx  OPM_UNUSED,
                                  PrimaryVariables& nextValue,
@@ -842,7 +986,7 @@ protected:
     void writeConvergence_(const SolutionVector& currentSolution,
                            const GlobalEqVector& solutionUpdate)
     {
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence)) {
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence)) {
             convergenceWriter_.beginIteration();
             convergenceWriter_.writeFields(currentSolution, solutionUpdate);
             convergenceWriter_.endIteration();
@@ -924,7 +1068,7 @@ protected:
      */
     void end_()
     {
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.endTimeStep();
     }
 
@@ -946,10 +1090,10 @@ protected:
 
     // optimal number of iterations we want to achieve
     int targetIterations_() const
-    { return EWOMS_GET_PARAM(TypeTag, int, NewtonTargetIterations); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, int, NewtonTargetIterations); }
     // maximum number of iterations we do before giving up
     int maxIterations_() const
-    { return EWOMS_GET_PARAM(TypeTag, int, NewtonMaxIterations); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, int, NewtonMaxIterations); }
 
     static bool enableConstraints_()
     { return GET_PROP_VALUE(TypeTag, EnableConstraints); }
@@ -0,0 +1,185 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::AtomicBitVector
+ */
+#ifndef EWOMS_ATOMIC_BIT_VECTOR_HH
+#define EWOMS_ATOMIC_BIT_VECTOR_HH
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace Opm {
+
+/*!
+ * \brief A vector of bits which can be concurrently modified by multiple threads.
+ *
+ * In contrast to std::vector<bool>, setting or clearing different bits of an
+ * AtomicBitVector from different threads does not constitute a data race even if the
+ * bits are stored in the same machine word: All modifications are done using atomic
+ * read-modify-write operations on the word which contains the bit.
+ *
+ * Resizing, filling, copying and swapping vectors are not thread safe.
+ */
+class AtomicBitVector
+{
+    typedef uint64_t Word;
+    static const size_t bitsPerWord = 8*sizeof(Word);
+
+public:
+    AtomicBitVector()
+        : size_(0)
+        , numWords_(0)
+    { }
+
+    AtomicBitVector(const AtomicBitVector& other)
+        : size_(0)
+        , numWords_(0)
+    { *this = other; }
+
+    AtomicBitVector(AtomicBitVector&& other)
+        : size_(0)
+        , numWords_(0)
+    { swap(other); }
+
+    AtomicBitVector& operator=(AtomicBitVector&& other)
+    {
+        swap(other);
+        return *this;
+    }
+
+    /*!
+     * \brief Exchange the contents of two bit vectors without copying any bits.
+     */
+    void swap(AtomicBitVector& other)
+    {
+        std::swap(words_, other.words_);
+        std::swap(size_, other.size_);
+        std::swap(numWords_, other.numWords_);
+    }
+
+    AtomicBitVector& operator=(const AtomicBitVector& other)
+    {
+        if (this == &other)
+            return *this;
+
+        if (numWords_ != other.numWords_) {
+            words_.reset(new std::atomic<Word>[other.numWords_]);
+            numWords_ = other.numWords_;
+        }
+        size_ = other.size_;
+
+        for (size_t wordIdx = 0; wordIdx < numWords_; ++wordIdx)
+            words_[wordIdx].store(other.words_[wordIdx].load(std::memory_order_relaxed),
+                                  std::memory_order_relaxed);
+
+        return *this;
+    }
+
+    /*!
+     * \brief Change the number of bits of the vector.
+     *
+     * All bits are set to the specified value afterwards.
+     */
+    void resize(size_t newSize, bool value = false)
+    {
+        size_t newNumWords = (newSize + bitsPerWord - 1)/bitsPerWord;
+        if (newNumWords != numWords_) {
+            words_.reset(new std::atomic<Word>[newNumWords]);
+            numWords_ = newNumWords;
+        }
+        size_ = newSize;
+
+        fill(value);
+    }
+
+    /*!
+     * \brief Returns the number of bits of the vector.
+     */
+    size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Set all bits to a given value.
+     */
+    void fill(bool value)
+    {
+        Word w = value ? ~static_cast<Word>(0) : static_cast<Word>(0);
+        for (size_t wordIdx = 0; wordIdx < numWords_; ++wordIdx)
+            words_[wordIdx].store(w, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns the value of a bit.
+     *
+     * By default, this uses acquire semantics, i.e., if the bit was set by another
+     * thread using release semantics, all writes which this thread did before setting
+     * the bit are visible afterwards.
+     */
+    bool test(size_t idx, std::memory_order order = std::memory_order_acquire) const
+    { return (words_[idx/bitsPerWord].load(order) & mask_(idx)) != 0; }
+
+    /*!
+     * \brief Set a bit to a given value.
+     *
+     * By default, this uses release semantics.
+     */
+    void set(size_t idx, bool value = true, std::memory_order order = std::memory_order_release)
+    {
+        if (value)
+            words_[idx/bitsPerWord].fetch_or(mask_(idx), order);
+        else
+            words_[idx/bitsPerWord].fetch_and(~mask_(idx), order);
+    }
+
+    /*!
+     * \brief Clear a bit.
+     */
+    void reset(size_t idx, std::memory_order order = std::memory_order_release)
+    { set(idx, /*value=*/false, order); }
+
+    /*!
+     * \brief Set a bit and return its previous value.
+     *
+     * If multiple threads call this method for the same bit concurrently, it returns
+     * false for exactly one of them.
+     */
+    bool testAndSet(size_t idx, std::memory_order order = std::memory_order_acq_rel)
+    { return (words_[idx/bitsPerWord].fetch_or(mask_(idx), order) & mask_(idx)) != 0; }
+
+private:
+    static Word mask_(size_t idx)
+    { return static_cast<Word>(1) << (idx % bitsPerWord); }
+
+    std::unique_ptr<std::atomic<Word>[]> words_;
+    size_t size_;
+    size_t numWords_;
+};
+
+} // namespace Opm
+
+#endif
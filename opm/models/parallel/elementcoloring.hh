@@ -0,0 +1,127 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ElementColoring
+ */
+#ifndef EWOMS_ELEMENT_COLORING_HH
+#define EWOMS_ELEMENT_COLORING_HH
+
+#include <vector>
+#include <cstddef>
+
+namespace Opm {
+
+/*!
+ * \brief Partitions the elements of a grid view into sets ("colors") so that no two
+ *        elements of the same color share a primary degree of freedom.
+ *
+ * When linearizing an element, the global system of equations is only modified in the
+ * columns of the Jacobian matrix and the entries of the residual which belong to the
+ * element's primary degrees of freedom. As a consequence, all elements of a given color
+ * can be processed concurrently without any locking, while the colors themselves are
+ * processed one after another.
+ *
+ * The coloring is determined using a greedy algorithm, i.e., each element gets the
+ * smallest color which is not yet used by any element which shares one of its primary
+ * degrees of freedom. For the element centered finite volume discretization this means
+ * that all elements end up with the same color.
+ */
+template <class GridView>
+class ElementColoring
+{
+    typedef typename GridView::template Codim<0>::Entity Element;
+    typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+
+public:
+    typedef typename Element::EntitySeed ElementSeed;
+
+    ElementColoring()
+    { }
+
+    /*!
+     * \brief Compute the coloring for the elements of a grid view.
+     *
+     * \param gridView The grid view of which the elements ought to be colored
+     * \param stencil A stencil object which is used to determine the primary degrees of
+     *                freedom of the elements
+     * \param numDof The total number of degrees of freedom of the grid
+     */
+    template <class Stencil>
+    void update(const GridView& gridView, Stencil& stencil, size_t numDof)
+    {
+        elementSeeds_.clear();
+
+        // the colors which are already used by the elements attached to a given
+        // degree of freedom
+        std::vector<std::vector<unsigned> > dofColors(numDof);
+        std::vector<bool> colorIsUsed;
+
+        ElementIterator elemIt = gridView.template begin</*codim=*/0>();
+        const ElementIterator& elemEndIt = gridView.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            stencil.update(elem);
+
+            // find the smallest color which is not used by any neighbor
+            colorIsUsed.assign(elementSeeds_.size() + 1, false);
+            unsigned numPrimaryDof = stencil.numPrimaryDof();
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++primaryDofIdx) {
+                unsigned globalIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                for (unsigned colorIdx : dofColors[globalIdx])
+                    colorIsUsed[colorIdx] = true;
+            }
+
+            unsigned color = 0;
+            while (colorIsUsed[color])
+                ++ color;
+
+            if (color == elementSeeds_.size())
+                elementSeeds_.resize(color + 1);
+            elementSeeds_[color].push_back(elem.seed());
+
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++primaryDofIdx) {
+                unsigned globalIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                dofColors[globalIdx].push_back(color);
+            }
+        }
+    }
+
+    /*!
+     * \brief Returns the number of colors used by the coloring.
+     */
+    size_t numColors() const
+    { return elementSeeds_.size(); }
+
+    /*!
+     * \brief Returns the seeds of all elements which exhibit a given color.
+     */
+    const std::vector<ElementSeed>& elementSeeds(unsigned colorIdx) const
+    { return elementSeeds_[colorIdx]; }
+
+private:
+    std::vector<std::vector<ElementSeed> > elementSeeds_;
+};
+} // namespace Opm
+
+#endif
@@ -27,8 +27,17 @@
 #ifndef EWOMS_THREADED_ENTITY_ITERATOR_HH
 #define EWOMS_THREADED_ENTITY_ITERATOR_HH
 
-#include <thread>
-#include <mutex>
+#include <opm/models/utils/alignedallocator.hh>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <atomic>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include <cstddef>
 
 namespace Opm {
 
@@ -36,6 +45,14 @@ namespace Opm {
  * \brief Provides an STL-iterator like interface to iterate over the enties of a
  *        GridView in OpenMP threaded applications
  *
+ * The entities are handed out to the threads in chunks of consecutive entities. The
+ * next chunk to be processed is determined using an atomic counter, i.e., no locks are
+ * required. The iterators pointing to the first entity of each chunk are determined
+ * by a single sequential pass over the grid, so claiming a chunk is a constant-time
+ * operation. Since these iterators only depend on the grid view and the chunk size,
+ * they can also be computed once by the user and be reused for all loops over the
+ * grid until it changes.
+ *
  * ATTENTION: This class must be instantiated in a sequential context!
  */
 template <class GridView, int codim>
@@ -43,58 +60,164 @@ class ThreadedEntityIterator
 {
     typedef typename GridView::template Codim<codim>::Entity Entity;
     typedef typename GridView::template Codim<codim>::Iterator EntityIterator;
+
+    // the state of the iteration of a single thread. this is aligned to the size of a
+    // cache line to avoid false sharing.
+    struct alignas(64) ThreadState
+    {
+        ThreadState(const EntityIterator& initialIt)
+            : it(initialIt)
+            , pos(0)
+            , chunkEnd(0)
+        {}
+
+        EntityIterator it;
+        size_t pos; // the index of the entity pointed to by 'it'
+        size_t chunkEnd; // the index of the first entity not part of the current chunk
+    };
+
 public:
-    ThreadedEntityIterator(const GridView& gridView)
-        : gridView_(gridView)
-        , sequentialIt_(gridView_.template begin<codim>())
-        , sequentialEnd_(gridView.template end<codim>())
-    { }
+    //! The iterators which point to the first entity of each chunk
+    typedef std::vector<EntityIterator> ChunkBeginVector;
+
+    /*!
+     * \brief Determine the iterators which point to the first entity of each chunk.
+     *
+     * The result can be passed to the constructor as long as the grid view does not
+     * change.
+     */
+    static void computeChunkBegins(ChunkBeginVector& chunkBegins,
+                                   const GridView& gridView,
+                                   unsigned chunkSize = 1)
+    {
+        size_t n = std::max<size_t>(chunkSize, 1);
 
-    ThreadedEntityIterator(const ThreadedEntityIterator& other) = default;
+        chunkBegins.clear();
+        chunkBegins.reserve((static_cast<size_t>(gridView.size(codim)) + n - 1)/n);
+
+        auto it = gridView.template begin<codim>();
+        const auto& endIt = gridView.template end<codim>();
+        for (size_t entityIdx = 0; it != endIt; ++it, ++entityIdx)
+            if (entityIdx % n == 0)
+                chunkBegins.push_back(it);
+    }
+
+    ThreadedEntityIterator(const GridView& gridView, unsigned chunkSize = 1)
+        : sequentialEnd_(gridView.template end<codim>())
+        , numEntities_(static_cast<size_t>(gridView.size(codim)))
+        , chunkSize_(std::max<size_t>(chunkSize, 1))
+        , nextChunkIdx_(0)
+    {
+        computeChunkBegins(ownChunkBegins_, gridView, chunkSize);
+        chunkBegins_ = &ownChunkBegins_;
+        threadState_.resize(maxThreads_(), ThreadState(sequentialEnd_));
+    }
+
+    /*!
+     * \brief Create a threaded iterator using chunk begins which have been determined
+     *        using computeChunkBegins() for the same grid view and chunk size.
+     *
+     * The chunk begins must stay alive while the iterator is used.
+     */
+    ThreadedEntityIterator(const GridView& gridView,
+                           const ChunkBeginVector& chunkBegins,
+                           unsigned chunkSize = 1)
+        : sequentialEnd_(gridView.template end<codim>())
+        , numEntities_(static_cast<size_t>(gridView.size(codim)))
+        , chunkSize_(std::max<size_t>(chunkSize, 1))
+        , chunkBegins_(&chunkBegins)
+        , nextChunkIdx_(0)
+    {
+        assert(chunkBegins.size() == (numEntities_ + chunkSize_ - 1)/chunkSize_);
+        threadState_.resize(maxThreads_(), ThreadState(sequentialEnd_));
+    }
+
+    ThreadedEntityIterator(const ThreadedEntityIterator& other) = delete;
 
     // begin iterating over the grid in parallel
     EntityIterator beginParallel()
     {
-        mutex_.lock();
-        auto tmp = sequentialIt_;
-        if (sequentialIt_ != sequentialEnd_)
-            ++sequentialIt_; // make the next thread look at the next element
-        mutex_.unlock();
+        ThreadState& ts = threadState_[threadId_()];
+        claimNextChunk_(ts);
 
-        return tmp;
+        return ts.it;
     }
 
     // returns true if the last element was reached
     bool isFinished(const EntityIterator& it) const
     { return it == sequentialEnd_; }
 
-    // make sure that the loop over the grid is finished
+    // make sure that the loop over the grid is finished. note that the threads which
+    // are currently working on a chunk of entities will only notice this once their
+    // current chunk is exhausted.
     void setFinished()
-    {
-        mutex_.lock();
-        sequentialIt_ = sequentialEnd_;
-        mutex_.unlock();
-    }
+    { nextChunkIdx_.store(chunkBegins_->size()); }
 
     // prefix increment: goes to the next element which is not yet worked on by any
     // thread
     EntityIterator increment()
     {
-        mutex_.lock();
-        auto tmp = sequentialIt_;
-        if (sequentialIt_ != sequentialEnd_)
-            ++sequentialIt_;
-        mutex_.unlock();
+        ThreadState& ts = threadState_[threadId_()];
+        if (ts.it == sequentialEnd_)
+            return ts.it;
+
+        ++ts.it;
+        ++ts.pos;
+        if (ts.pos >= ts.chunkEnd)
+            claimNextChunk_(ts);
 
-        return tmp;
+        return ts.it;
     }
 
 private:
-    GridView gridView_;
-    EntityIterator sequentialIt_;
+    // atomically reserve the next chunk of entities for a thread and point the
+    // thread's iterator to its beginning
+    void claimNextChunk_(ThreadState& ts)
+    {
+        const size_t numChunks = chunkBegins_->size();
+        size_t chunkIdx = nextChunkIdx_.load(std::memory_order_relaxed);
+        if (chunkIdx < numChunks)
+            chunkIdx = nextChunkIdx_.fetch_add(1, std::memory_order_relaxed);
+
+        if (chunkIdx >= numChunks) {
+            ts.it = sequentialEnd_;
+            ts.pos = numEntities_;
+            ts.chunkEnd = numEntities_;
+            return;
+        }
+
+        ts.it = (*chunkBegins_)[chunkIdx];
+        ts.pos = chunkIdx*chunkSize_;
+        ts.chunkEnd = std::min(ts.pos + chunkSize_, numEntities_);
+    }
+
+    static unsigned threadId_()
+    {
+#ifdef _OPENMP
+        return static_cast<unsigned>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    static unsigned maxThreads_()
+    {
+#ifdef _OPENMP
+        return static_cast<unsigned>(omp_get_max_threads());
+#else
+        return 1;
+#endif
+    }
+
     EntityIterator sequentialEnd_;
+    size_t numEntities_;
+    size_t chunkSize_;
+
+    ChunkBeginVector ownChunkBegins_;
+    const ChunkBeginVector* chunkBegins_;
 
-    std::mutex mutex_;
+    std::vector<ThreadState, Opm::aligned_allocator<ThreadState, alignof(ThreadState)> > threadState_;
+    std::atomic<size_t> nextChunkIdx_;
 };
 } // namespace Opm
 
@@ -41,6 +41,7 @@
 BEGIN_PROPERTIES
 
 NEW_PROP_TAG(ThreadsPerProcess);
+NEW_PROP_TAG(ThreadedLoopChunkSize);
 
 END_PROPERTIES
 
@@ -70,11 +71,18 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, ThreadsPerProcess,
                              "The maximum number of threads to be instantiated per process "
                              "('-1' means 'automatic')");
+        EWOMS_REGISTER_PARAM(TypeTag, int, ThreadedLoopChunkSize,
+                             "The number of consecutive grid entities which are handed to a "
+                             "thread at once by threaded loops over the grid");
     }
 
     static void init()
     {
         numThreads_ = EWOMS_GET_PARAM(TypeTag, int, ThreadsPerProcess);
+        chunkSize_ = EWOMS_GET_PARAM(TypeTag, int, ThreadedLoopChunkSize);
+        if (chunkSize_ < 1)
+            throw std::invalid_argument("The chunk size of threaded loops must be at least 1 "
+                                        "(is: "+std::to_string(chunkSize_)+")!");
 
         // some safety checks. This is pretty ugly macro-magic, but so what?
 #if !defined(_OPENMP)
@@ -111,6 +119,13 @@ public:
     static unsigned maxThreads()
     { return static_cast<unsigned>(numThreads_); }
 
+    /*!
+     * \brief Return the number of grid entities which are handed to a thread at once by
+     *        threaded loops over the grid.
+     */
+    static unsigned chunkSize()
+    { return static_cast<unsigned>(chunkSize_); }
+
     /*!
      * \brief Return the index of the current OpenMP thread
      */
@@ -125,10 +140,14 @@ public:
 
 private:
     static int numThreads_;
+    static int chunkSize_;
 };
 
 template <class TypeTag>
 int ThreadManager<TypeTag>::numThreads_ = 1;
+
+template <class TypeTag>
+int ThreadManager<TypeTag>::chunkSize_ = 1;
 } // namespace Opm
 
 #endif
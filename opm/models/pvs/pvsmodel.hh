@@ -46,11 +46,14 @@
 #include <opm/models/io/vtkcompositionmodule.hh>
 #include <opm/models/io/vtkenergymodule.hh>
 #include <opm/models/io/vtkdiffusionmodule.hh>
+#include <opm/models/parallel/atomicbitvector.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 #include <opm/material/common/Exceptions.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -231,6 +234,7 @@ class PvsModel
     typedef typename GET_PROP_TYPE(TypeTag, IntensiveQuantities) IntensiveQuantities;
     typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
     typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
 
     enum { numPhases = GET_PROP_VALUE(TypeTag, NumPhases) };
     enum { numComponents = GET_PROP_VALUE(TypeTag, NumComponents) };
@@ -465,59 +469,81 @@ public:
     {
         numSwitched_ = 0;
 
-        int succeeded;
-        try {
-            std::vector<bool> visited(this->numGridDof(), false);
+        // the DOFs which are shared by several elements are handled by the thread which
+        // claims them first. each thread counts its switched DOFs separately.
+        Opm::AtomicBitVector visited;
+        visited.resize(this->numGridDof(), /*value=*/false);
+        int succeeded = 1;
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView_, ThreadManager::chunkSize());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            // Attention: the variables below are thread specific and thus cannot be
+            // moved in front of the #pragma!
             ElementContext elemCtx(this->simulator_);
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            unsigned threadNumSwitched = 0;
+            int threadSucceeded = 1;
+
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const Element& elem = *elemIt;
+                    if (elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+                    elemCtx.updateStencil(elem);
 
-            ElementIterator elemIt = this->gridView_.template begin<0>();
-            ElementIterator elemEndIt = this->gridView_.template end<0>();
-            for (; elemIt != elemEndIt; ++elemIt) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue;
-                elemCtx.updateStencil(elem);
+                    size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
+                    for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
 
-                size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
-                for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
-                    unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                        if (visited.testAndSet(globalIdx))
+                            continue;
 
-                    if (visited[globalIdx])
-                        continue;
-                    visited[globalIdx] = true;
-
-                    // compute the intensive quantities of the current degree of freedom
-                    auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
-                    elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-                    const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
-
-                    // evaluate primary variable switch
-                    short oldPhasePresence = priVars.phasePresence();
-
-                    // set the primary variables and the new phase state
-                    // from the current fluid state
-                    priVars.assignNaive(intQuants.fluidState());
-
-                    if (oldPhasePresence != priVars.phasePresence()) {
-                        if (verbosity_ > 1)
-                            printSwitchedPhases_(elemCtx,
-                                                 dofIdx,
-                                                 intQuants.fluidState(),
-                                                 oldPhasePresence,
-                                                 priVars);
-                        ++numSwitched_;
+                        // compute the intensive quantities of the current degree of freedom
+                        auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
+                        elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
+                        const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+
+                        // evaluate primary variable switch
+                        short oldPhasePresence = priVars.phasePresence();
+
+                        // set the primary variables and the new phase state
+                        // from the current fluid state
+                        priVars.assignNaive(intQuants.fluidState());
+
+                        if (oldPhasePresence != priVars.phasePresence()) {
+                            if (verbosity_ > 1) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                                printSwitchedPhases_(elemCtx,
+                                                     dofIdx,
+                                                     intQuants.fluidState(),
+                                                     oldPhasePresence,
+                                                     priVars);
+                            }
+                            ++threadNumSwitched;
+                        }
                     }
                 }
             }
+            catch (...)
+            {
+                std::cout << "rank " << this->simulator_.gridView().comm().rank()
+                          << " caught an exception during primary variable switching"
+                          << "\n"  << std::flush;
+                threadSucceeded = 0;
+            }
 
-            succeeded = 1;
-        }
-        catch (...)
-        {
-            std::cout << "rank " << this->simulator_.gridView().comm().rank()
-                      << " caught an exception during primary variable switching"
-                      << "\n"  << std::flush;
-            succeeded = 0;
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            {
+                numSwitched_ += threadNumSwitched;
+                succeeded = std::min(succeeded, threadSucceeded);
+            }
         }
         succeeded = this->simulator_.gridView().comm().min(succeeded);
 
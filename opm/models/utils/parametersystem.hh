@@ -118,6 +118,31 @@
     (::Opm::Parameters::get<TypeTag, ParamType, PTAG(ParamName)>(#ParamName, \
                                                                  #ParamName))
 
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Retrieve a runtime parameter from the snapshot of the parameter values.
+ *
+ * This is semantically equivalent to \c EWOMS_GET_PARAM, but the value of the
+ * parameter is resolved only once after the registration of parameters has been
+ * finished and again after each time the parameter values have been read (i.e., by
+ * the \c parseCommandLineOptions() and \c parseParameterFile() functions). Accessing
+ * it thus does not require to look up and to parse the value of the parameter, which
+ * makes this macro suitable for code paths which are executed very often, like the
+ * ones which are called for each degree of freedom or for each iteration.
+ *
+ * Example:
+ *
+ * \code
+ * // Retrieves scalar value UpwindWeight, default
+ * // is taken from the property UpwindWeight
+ * EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, UpwindWeight);
+ * \endcode
+ */
+#define EWOMS_GET_CACHED_PARAM(TypeTag, ParamType, ParamName)                  \
+    (::Opm::Parameters::getCached<TypeTag, ParamType, PTAG(ParamName)>(#ParamName, \
+                                                                       #ParamName))
+
 //!\cond SKIP_THIS
 #define EWOMS_GET_PARAM_(TypeTag, ParamType, ParamName)                 \
     (::Opm::Parameters::get<TypeTag, ParamType, PTAG(ParamName)>(     \
@@ -181,6 +206,9 @@ const ParamType get(const char *propTagName,
                     const char *paramName,
                     bool errorIfNotRegistered = true);
 
+template <class TypeTag>
+unsigned revision_();
+
 class ParamRegFinalizerBase_
 {
 public:
@@ -189,6 +217,24 @@ public:
     virtual void retrieve() = 0;
 };
 
+// the snapshot of the value of a parameter. "revision" is the revision of the
+// parameter values for which "value" was resolved.
+template <class TypeTag, class ParamType, class PropTag>
+struct ParamSnapshot_
+{
+    static ParamType& value()
+    {
+        static ParamType val;
+        return val;
+    }
+
+    static unsigned& revision()
+    {
+        static unsigned rev = 0;
+        return rev;
+    }
+};
+
 template <class TypeTag, class ParamType, class PropTag>
 class ParamRegFinalizer_ : public ParamRegFinalizerBase_
 {
@@ -199,12 +245,15 @@ public:
 
     virtual void retrieve() override
     {
-        // retrieve the parameter once to make sure that its value does
-        // not contain a syntax error.
-        ParamType __attribute__((unused)) dummy =
+        // retrieve the parameter to make sure that its value does not contain a syntax
+        // error and put it into the snapshot of the parameter values.
+        typedef ParamSnapshot_<TypeTag, ParamType, PropTag> Snapshot;
+
+        Snapshot::value() =
             get<TypeTag, ParamType, PropTag>(/*propTagName=*/paramName_.data(),
                                              paramName_.data(),
                                              /*errorIfNotRegistered=*/true);
+        Snapshot::revision() = revision_<TypeTag>();
     }
 
 private:
@@ -240,15 +289,25 @@ SET_PROP(ParameterSystem, ParameterMetaData)
     static std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > &registrationFinalizers()
     { return storage_().finalizers; }
 
+    static std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > &snapshotResolvers()
+    { return storage_().snapshotResolvers; }
+
     static bool& registrationOpen()
     { return storage_().registrationOpen; }
 
+    // the revision of the parameter values. this is incremented each time the values
+    // may have changed, which invalidates the snapshot of the parameter values.
+    static unsigned& revision()
+    { return storage_().revision; }
+
     static void clear()
     {
         storage_().tree.reset(new Dune::ParameterTree());
         storage_().finalizers.clear();
+        storage_().snapshotResolvers.clear();
         storage_().registrationOpen = true;
         storage_().registry.clear();
+        ++ storage_().revision;
     }
 
 private:
@@ -261,12 +320,15 @@ private:
         {
             tree.reset(new Dune::ParameterTree());
             registrationOpen = true;
+            revision = 1;
         }
 
         std::unique_ptr<Dune::ParameterTree> tree;
         std::map<std::string, ::Opm::Parameters::ParamInfo> registry;
         std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > finalizers;
+        std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > snapshotResolvers;
         bool registrationOpen;
+        unsigned revision;
     };
     static Storage_& storage_() {
         static Storage_ obj;
@@ -281,6 +343,8 @@ namespace Opm {
 
 namespace Parameters {
 // function prototype declarations
+template <class TypeTag>
+void updateSnapshot_();
 void printParamUsage_(std::ostream& os, const ParamInfo& paramInfo);
 void getFlattenedKeyList_(std::list<std::string>& dest,
                           const Dune::ParameterTree& tree,
@@ -760,6 +824,8 @@ std::string parseCommandLineOptions(int argc,
         // Put the key=value pair into the parameter tree
         paramTree[paramName] = paramValue;
     }
+
+    updateSnapshot_<TypeTag>();
     return "";
 }
 
@@ -828,6 +894,8 @@ void parseParameterFile(const std::string& fileName, bool overwrite = true)
         if (overwrite || !paramTree.hasKey(canonicalKey))
             paramTree[canonicalKey] = value;
     }
+
+    updateSnapshot_<TypeTag>();
 }
 
 /*!
@@ -1079,6 +1147,27 @@ const ParamType get(const char *propTagName, const char *paramName, bool errorIf
                                                             errorIfNotRegistered);
 }
 
+template <class TypeTag>
+unsigned revision_()
+{
+    typedef typename GET_PROP(TypeTag, ParameterMetaData) ParamsMeta;
+    return ParamsMeta::revision();
+}
+
+template <class TypeTag, class ParamType, class PropTag>
+const ParamType getCached(const char *propTagName, const char *paramName)
+{
+    typedef ParamSnapshot_<TypeTag, ParamType, PropTag> Snapshot;
+
+    if (Snapshot::revision() == revision_<TypeTag>())
+        return Snapshot::value();
+
+    // the snapshot is not up to date. this happens if the parameter was not registered
+    // for the same type tag or if the parameter values have been modified in an unusual
+    // way. the parameter value is thus looked up the conventional way.
+    return get<TypeTag, ParamType, PropTag>(propTagName, paramName);
+}
+
 template <class TypeTag, class Container>
 void getLists(Container& usedParams, Container& unusedParams)
 {
@@ -1131,6 +1220,8 @@ void registerParam(const char *paramName, const char *propertyName, const char *
 
     ParamsMeta::registrationFinalizers().emplace_back(
         new ParamRegFinalizer_<TypeTag, ParamType, PropTag>(paramName));
+    ParamsMeta::snapshotResolvers().emplace_back(
+        new ParamRegFinalizer_<TypeTag, ParamType, PropTag>(paramName));
 
     ParamInfo paramInfo;
     paramInfo.paramName = paramName;
@@ -1187,13 +1278,30 @@ void endParamRegistration()
     ParamsMeta::registrationOpen() = false;
 
     // loop over all parameters and retrieve their values to make sure
-    // that there is no syntax error
+    // that there is no syntax error. this also creates the initial snapshot of the
+    // parameter values.
     auto pIt = ParamsMeta::registrationFinalizers().begin();
     const auto& pEndIt = ParamsMeta::registrationFinalizers().end();
     for (; pIt != pEndIt; ++pIt)
         (*pIt)->retrieve();
     ParamsMeta::registrationFinalizers().clear();
 }
+
+// invalidate the snapshot of the parameter values and resolve it again if all
+// parameters have been registered
+template <class TypeTag>
+void updateSnapshot_()
+{
+    typedef typename GET_PROP(TypeTag, ParameterMetaData) ParamsMeta;
+    ++ ParamsMeta::revision();
+
+    if (ParamsMeta::registrationOpen())
+        // the snapshot will be created at the end of the registration
+        return;
+
+    for (auto& resolver : ParamsMeta::snapshotResolvers())
+        resolver->retrieve();
+}
 //! \endcond
 
 } // namespace Parameters
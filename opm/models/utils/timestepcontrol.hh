@@ -0,0 +1,342 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Strategies to determine the size of the next time step.
+ */
+#ifndef EWOMS_TIME_STEP_CONTROL_HH
+#define EWOMS_TIME_STEP_CONTROL_HH
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief The information about an attempted time step which is passed to the time
+ *        step controllers.
+ */
+template <class Scalar>
+struct TimeStepInfo
+{
+    //! The simulated time at the beginning of the time step [s]
+    Scalar time;
+
+    //! The size of the attempted time step [s]
+    Scalar timeStepSize;
+
+    //! The number of Newton iterations which were done for the time step
+    int numNewtonIterations;
+
+    //! The maximum weighted change of any primary variable over the time step. This is
+    //! only computed for successful time steps if the controller requires it.
+    Scalar relativeChange;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief The interface of all time step controllers.
+ *
+ * A time step controller proposes the size of the next time step after a time step
+ * was successful and the size to be used for the next attempt after the time
+ * integration has failed.
+ */
+template <class Scalar>
+class TimeStepControlInterface
+{
+public:
+    virtual ~TimeStepControlInterface()
+    { }
+
+    /*!
+     * \brief Returns a human readable name of the controller.
+     */
+    virtual std::string name() const = 0;
+
+    /*!
+     * \brief Returns true if the controller uses the relative change of the primary
+     *        variables.
+     */
+    virtual bool requiresRelativeChange() const
+    { return false; }
+
+    /*!
+     * \brief Returns the proposed size of the time step which follows a successful
+     *        one.
+     */
+    virtual Scalar nextTimeStepSize(const TimeStepInfo<Scalar>& info) = 0;
+
+    /*!
+     * \brief Returns the time step size which is to be used to retry a failed time
+     *        step.
+     *
+     * The default is to halve the time step size.
+     */
+    virtual Scalar retryTimeStepSize(const TimeStepInfo<Scalar>& info)
+    { return info.timeStepSize/2; }
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief A time step controller which asks a function for the size of the next time
+ *        step.
+ *
+ * This is used to keep the time step size suggested by the Newton method.
+ */
+template <class Scalar>
+class DelegatingTimeStepControl : public TimeStepControlInterface<Scalar>
+{
+public:
+    typedef std::function<Scalar(Scalar)> SuggestFunction;
+
+    DelegatingTimeStepControl(const std::string& name, SuggestFunction suggestFn)
+        : name_(name)
+        , suggestFn_(suggestFn)
+    { }
+
+    std::string name() const override
+    { return name_; }
+
+    Scalar nextTimeStepSize(const TimeStepInfo<Scalar>& info) override
+    { return suggestFn_(info.timeStepSize); }
+
+private:
+    std::string name_;
+    SuggestFunction suggestFn_;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief A time step controller which shrinks the time step size if the Newton method
+ *        required more than the targeted number of iterations and grows it otherwise.
+ */
+template <class Scalar>
+class IterationCountTimeStepControl : public TimeStepControlInterface<Scalar>
+{
+public:
+    IterationCountTimeStepControl(int targetIterations, Scalar decayRate, Scalar growthRate)
+        : targetIterations_(targetIterations)
+        , decayRate_(decayRate)
+        , growthRate_(growthRate)
+    { }
+
+    std::string name() const override
+    { return "iteration-count"; }
+
+    Scalar nextTimeStepSize(const TimeStepInfo<Scalar>& info) override
+    {
+        if (info.numNewtonIterations > targetIterations_)
+            return info.timeStepSize*decayRate_;
+        else if (info.numNewtonIterations < targetIterations_)
+            return info.timeStepSize*growthRate_;
+        return info.timeStepSize;
+    }
+
+private:
+    int targetIterations_;
+    Scalar decayRate_;
+    Scalar growthRate_;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief A PID controller on the relative change of the primary variables.
+ *
+ * The time step size is chosen such that the maximum weighted change of the primary
+ * variables over a time step approaches a given tolerance. If the change was larger
+ * than the tolerance, the time step size is reduced proportionally. Otherwise, the
+ * proportional, integral and derivative gains of
+ *
+ * Söderlind, G.: Digital filters in adaptive time-stepping, ACM Transactions on
+ * Mathematical Software, 29(1), pp 1-26, 2003
+ *
+ * are used to determine the new time step size.
+ */
+template <class Scalar>
+class PidTimeStepControl : public TimeStepControlInterface<Scalar>
+{
+public:
+    PidTimeStepControl(Scalar tolerance, Scalar maxGrowth)
+        : tolerance_(tolerance)
+        , maxGrowth_(maxGrowth)
+    { std::fill(errors_, errors_ + 3, tolerance_); }
+
+    std::string name() const override
+    { return "pid"; }
+
+    bool requiresRelativeChange() const override
+    { return true; }
+
+    Scalar nextTimeStepSize(const TimeStepInfo<Scalar>& info) override
+    {
+        errors_[0] = errors_[1];
+        errors_[1] = errors_[2];
+        errors_[2] = std::max<Scalar>(info.relativeChange, 1e-3*tolerance_);
+
+        if (errors_[2] > tolerance_)
+            return info.timeStepSize*tolerance_/errors_[2];
+
+        const Scalar kP = 0.075;
+        const Scalar kI = 0.175;
+        const Scalar kD = 0.01;
+        Scalar factor =
+            std::pow(errors_[1]/errors_[2], kP)
+            * std::pow(tolerance_/errors_[2], kI)
+            * std::pow(errors_[1]*errors_[1]/(errors_[0]*errors_[2]), kD);
+
+        return info.timeStepSize*std::min(factor, maxGrowth_);
+    }
+
+private:
+    Scalar tolerance_;
+    Scalar maxGrowth_;
+
+    // the relative changes of the last three successful time steps
+    Scalar errors_[3];
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief A time step controller which remembers where the most recent time step
+ *        failures happened.
+ *
+ * The sizes of the time steps are determined by another controller, but within the
+ * time interval of a failed time step, they are limited to the size which eventually
+ * succeeded. If a time step fails again inside such an interval, the size of the time
+ * step is reduced twice, i.e., fewer attempts are wasted on steps which are likely to
+ * fail.
+ *
+ * A failure is not forgotten as soon as the simulation has passed the interval of the
+ * failed time step: For a time span of 'memoryFactor' times the size of the failed
+ * time step after its end, the time step size may only grow by at most a factor of
+ * 'maxGrowth' per time step. This prevents the controller from immediately jumping
+ * back to the time step size which caused the failure.
+ */
+template <class Scalar>
+class FailureAwareTimeStepControl : public TimeStepControlInterface<Scalar>
+{
+    struct Failure
+    {
+        Scalar begin;
+        Scalar end;
+        Scalar succeededTimeStepSize;
+
+        // the time until which the growth of the time step size is limited
+        Scalar memoryEnd;
+    };
+
+public:
+    FailureAwareTimeStepControl(std::unique_ptr<TimeStepControlInterface<Scalar> > controller,
+                                Scalar memoryFactor,
+                                Scalar maxGrowth,
+                                unsigned maxFailures = 10)
+        : controller_(std::move(controller))
+        , memoryFactor_(memoryFactor)
+        , maxGrowth_(maxGrowth)
+        , maxFailures_(maxFailures)
+    { }
+
+    std::string name() const override
+    { return controller_->name() + "+failure-memory"; }
+
+    bool requiresRelativeChange() const override
+    { return controller_->requiresRelativeChange(); }
+
+    Scalar nextTimeStepSize(const TimeStepInfo<Scalar>& info) override
+    {
+        // the failures which occurred at the beginning of the time step have been
+        // overcome using the time step size of the current step
+        for (auto& failure : failures_)
+            if (failure.succeededTimeStepSize <= 0.0 && failure.begin <= info.time)
+                failure.succeededTimeStepSize = info.timeStepSize;
+
+        // forget about the failures which are sufficiently far in the past
+        Scalar nextTime = info.time + info.timeStepSize;
+        failures_.erase(std::remove_if(failures_.begin(),
+                                       failures_.end(),
+                                       [nextTime](const Failure& failure)
+                                       { return failure.memoryEnd <= nextTime; }),
+                        failures_.end());
+
+        Scalar dt = controller_->nextTimeStepSize(info);
+        for (const auto& failure : failures_) {
+            if (nextTime < failure.end)
+                // inside the interval of the failed time step
+                dt = std::min(dt, failure.succeededTimeStepSize);
+            else
+                // shortly after it
+                dt = std::min(dt, maxGrowth_*info.timeStepSize);
+        }
+
+        return dt;
+    }
+
+    Scalar retryTimeStepSize(const TimeStepInfo<Scalar>& info) override
+    {
+        bool repeatedFailure = false;
+        for (const auto& failure : failures_)
+            repeatedFailure = repeatedFailure
+                || (failure.begin < info.time + info.timeStepSize && info.time < failure.end);
+
+        if (failures_.size() >= maxFailures_)
+            failures_.erase(failures_.begin());
+        Scalar end = info.time + info.timeStepSize;
+        failures_.push_back(Failure{info.time,
+                                    end,
+                                    /*succeededTimeStepSize=*/0.0,
+                                    /*memoryEnd=*/end + memoryFactor_*info.timeStepSize});
+
+        Scalar dt = controller_->retryTimeStepSize(info);
+        if (repeatedFailure) {
+            TimeStepInfo<Scalar> reducedInfo(info);
+            reducedInfo.timeStepSize = dt;
+            dt = controller_->retryTimeStepSize(reducedInfo);
+        }
+
+        return dt;
+    }
+
+private:
+    std::unique_ptr<TimeStepControlInterface<Scalar> > controller_;
+    Scalar memoryFactor_;
+    Scalar maxGrowth_;
+    unsigned maxFailures_;
+    std::vector<Failure> failures_;
+};
+
+} // namespace Opm
+
+#endif
@@ -30,16 +30,70 @@
 #include "convergencecriterion.hh"
 #include "residreductioncriterion.hh"
 #include "linearsolverreport.hh"
+#include "krylovkernels.hh"
 
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 
 #include <opm/material/common/Exceptions.hpp>
+#include <opm/material/common/Unused.hpp>
 
+#include <array>
 #include <memory>
 
 namespace Opm {
 namespace Linear {
+/*!
+ * \brief The temporary vectors which are required by the BiCGStab solver.
+ *
+ * Keeping an object of this class alive across linear solves avoids to allocate these
+ * vectors for each solve. Since the vectors cannot tell whether they belong to a
+ * different parallel overlap with the same number of entries, the owner must call
+ * clear() whenever the structure of the linear system changes.
+ */
+template <class Vector>
+class BiCGStabWorkspace
+{
+public:
+    BiCGStabWorkspace()
+        : isValid_(false)
+    {}
+
+    /*!
+     * \brief Make sure that the vectors are structurally compatible to a given one.
+     *
+     * The vectors are only (re-)allocated if the workspace was cleared or if the size
+     * of the template vector differs from the one of the workspace vectors.
+     */
+    void prepare(const Vector& templateVec)
+    {
+        if (isValid_ && r.size() == templateVec.size())
+            return;
+
+        r = templateVec;
+        v = templateVec;
+        p = templateVec;
+        y = templateVec;
+        z = templateVec;
+        isValid_ = true;
+    }
+
+    /*!
+     * \brief Mark the vectors of the workspace as stale.
+     */
+    void clear()
+    { isValid_ = false; }
+
+    Vector r;
+    Vector v;
+    Vector p;
+    Vector y;
+    Vector z;
+
+private:
+    bool isValid_;
+};
+
 /*!
  * \brief Implements a preconditioned stabilized BiCG linear solver.
  *
@@ -48,27 +102,69 @@ namespace Linear {
  *
  * See https://en.wikipedia.org/wiki/Biconjugate_gradient_stabilized_method, (article
  * date: December 19, 2016)
+ *
+ * If the reductions are fused (cf. setFuseReductions()), the scalar products (t, t)
+ * and (t, s) which are required to determine omega are computed using a single global
+ * reduction. The same reduction also computes (r0hat, s) and (r0hat, t), which yields
+ * the scalar product (r0hat, r) of the next iteration without any additional
+ * communication because of r = s - omega*t. This requires the scalar product to
+ * provide a dots() method. (Otherwise, the scalar products are computed one after
+ * another.)
+ *
+ * The temporary vectors are taken from a BiCGStabWorkspace object. If no workspace is
+ * specified using setWorkspace(), they are allocated for each call to apply().
  */
-template <class LinearOperator, class Vector, class Preconditioner>
+template <class LinearOperator, class Vector, class Preconditioner,
+          class ScalarProduct = Dune::ScalarProduct<Vector> >
 class BiCGStabSolver
 {
     typedef Opm::Linear::ConvergenceCriterion<Vector> ConvergenceCriterion;
     typedef typename LinearOperator::field_type Scalar;
 
 public:
+    typedef BiCGStabWorkspace<Vector> Workspace;
+
     BiCGStabSolver(Preconditioner& preconditioner,
                    ConvergenceCriterion& convergenceCriterion,
-                   Dune::ScalarProduct<Vector>& scalarProduct)
-        : preconditioner_(preconditioner)
-        , convergenceCriterion_(convergenceCriterion)
+                   ScalarProduct& scalarProduct)
+        : preconditioner_(&preconditioner)
+        , convergenceCriterion_(&convergenceCriterion)
         , scalarProduct_(scalarProduct)
     {
         A_ = nullptr;
         b_ = nullptr;
+        workspace_ = nullptr;
 
         maxIterations_ = 1000;
+        fuseReductions_ = false;
     }
 
+    /*!
+     * \brief Specify whether the scalar products which are required by an iteration
+     *        ought to be computed using as few global reductions as possible.
+     *
+     * The results are mathematically identical to the ones of the conventional
+     * algorithm, but their rounding errors are different.
+     */
+    void setFuseReductions(bool value)
+    { fuseReductions_ = value; }
+
+    /*!
+     * \brief Returns true iff the scalar products of an iteration are computed using as
+     *        few global reductions as possible.
+     */
+    bool fuseReductions() const
+    { return fuseReductions_; }
+
+    /*!
+     * \brief Specify the object which provides the temporary vectors of the solver.
+     *
+     * The workspace must outlive all calls to apply(). Passing nullptr causes the
+     * temporary vectors to be allocated by each call to apply().
+     */
+    void setWorkspace(Workspace* workspace)
+    { workspace_ = workspace; }
+
     /*!
      * \brief Set the maximum number of iterations before we give up without achieving
      *        convergence.
@@ -114,6 +210,14 @@ public:
     void setRhs(const Vector* b)
     { b_ = b; }
 
+    /*!
+     * \brief Set the preconditioner which is used by the linear solver.
+     *
+     * This allows to keep the solver object if the preconditioner is recreated.
+     */
+    void setPreconditioner(Preconditioner& preconditioner)
+    { preconditioner_ = &preconditioner; }
+
     /*!
      * \brief Run the stabilized BiCG solver and store the result into the "x" vector.
      */
@@ -138,11 +242,22 @@ public:
         // set the initial solution to the zero vector
         x = 0.0;
 
+        // get the temporary vectors. if no workspace has been specified, use a
+        // throw-away one.
+        std::unique_ptr<Workspace> tmpWorkspace;
+        Workspace* workspace = workspace_;
+        if (!workspace) {
+            tmpWorkspace.reset(new Workspace);
+            workspace = tmpWorkspace.get();
+        }
+        workspace->prepare(x);
+
         // prepare the preconditioner. to allow some optimizations, we assume that the
         // preconditioner does not change the initial solution x if the initial solution
         // is a zero vector.
-        Vector r = *b_;
-        preconditioner_.pre(x, r);
+        Vector& r = workspace->r;
+        KrylovKernels::assign(r, *b_);
+        preconditioner_->pre(x, r);
 
 #ifndef NDEBUG
         // ensure that the preconditioner does not change the initial solution. since
@@ -156,15 +271,15 @@ public:
         }
 #endif // NDEBUG
 
-        convergenceCriterion_.setInitial(x, r);
-        if (convergenceCriterion_.converged()) {
+        convergenceCriterion_->setInitial(x, r);
+        if (convergenceCriterion_->converged()) {
             report_.setConverged(true);
             return report_.converged();
         }
 
         if (verbosity_ > 0) {
             std::cout << "-------- BiCGStabSolver --------" << std::endl;
-            convergenceCriterion_.printInitial();
+            convergenceCriterion_->printInitial();
         }
 
         // r0 = b - Ax (i.e., r -= A*x_0 = b, because x_0 == 0)
@@ -179,22 +294,29 @@ public:
         Scalar omega = 1.0;
 
         // v_0 = p_0 = 0;
-        Vector v(r);
+        Vector& v = workspace->v;
         v = 0.0;
-        Vector p(v);
+        Vector& p = workspace->p;
+        p = 0.0;
 
-        // create all the temporary vectors which we need. Be aware that some of them
+        // get all the temporary vectors which we need. Be aware that some of them
         // actually point to the same object because they are not needed at the same time!
-        Vector y(x);
+        Vector& y = workspace->y;
+        y = 0.0;
         Vector& h(x);
         Vector& s(r);
-        Vector z(x);
+        Vector& z = workspace->z;
+        z = 0.0;
         Vector& t(y);
-        unsigned n = x.size();
+
+        // (r0hat, r_i) if it was computed as part of the fused reduction of the
+        // previous iteration
+        Scalar nextRho = 0.0;
+        bool nextRhoValid = false;
 
         for (; report_.iterations() < maxIterations_; report_.increment()) {
             // rho_i = (r0hat,r_(i-1))
-            Scalar rho_i = scalarProduct_.dot(r0hat, r);
+            Scalar rho_i = nextRhoValid ? nextRho : scalarProduct_.dot(r0hat, r);
 
             // beta = (rho_i/rho_(i-1))*(alpha/omega_(i-1))
             if (std::abs(rho) <= breakdownEps || std::abs(omega) <= breakdownEps)
@@ -204,25 +326,13 @@ public:
             // make rho correspond to the current iteration (i.e., forget rho_(i-1))
             rho = rho_i;
 
-            // this loop conflates the following operations:
-            //
             // p_i = r_(i-1) + beta*(p_(i-1) - omega_(i-1)*v_(i-1))
-            // y = p
-            for (unsigned i = 0; i < n; ++i) {
-                // p_i = r_(i-1) + beta*(p_(i-1) - omega_(i-1)*v_(i-1))
-                auto tmp = v[i];
-                tmp *= omega;
-                tmp -= p[i];
-                tmp *= -beta;
-                p[i] = r[i];
-                p[i] += tmp;
-
-                // y = p; not required because the precontioner overwrites y anyway...
-                // y[i] = p[i];
-            }
+            //
+            // y = p is not required because the precontioner overwrites y anyway...
+            KrylovKernels::bicgstabSearchDirection(p, r, v, beta, omega);
 
             // y = K^-1 * p_i
-            preconditioner_.apply(y, p);
+            preconditioner_->apply(y, p);
 
             // v_i = A*y
             A_->apply(y, v);
@@ -237,34 +347,26 @@ public:
 
             // h = x_(i-1) + alpha*y
             // s = r_(i-1) - alpha*v_i
-            for (unsigned i = 0; i < n; ++i) {
-                auto tmp = y[i];
-                tmp *= alpha;
-                tmp += x[i];
-                h[i] = tmp;
-
-                //s[i] = r[i]; // not necessary because r and s are the same object
-                tmp = v[i];
-                tmp *= alpha;
-                s[i] -= tmp;
-            }
+            //
+            // h = x and s = r are not necessary because these are the same objects
+            KrylovKernels::bicgstabIntermediate(h, s, y, v, alpha);
 
             // do convergence check and print terminal output
-            convergenceCriterion_.update(/*curSol=*/h, /*delta=*/y, s);
-            if (convergenceCriterion_.converged()) {
+            convergenceCriterion_->update(/*curSol=*/h, /*delta=*/y, s);
+            if (convergenceCriterion_->converged()) {
                 if (verbosity_ > 0) {
-                    convergenceCriterion_.print(report_.iterations() + 0.5);
+                    convergenceCriterion_->print(report_.iterations() + 0.5);
                     std::cout << "-------- /BiCGStabSolver --------" << std::endl;
                 }
 
                 // x = h; // not necessary because x and h are the same object
-                preconditioner_.post(x);
+                preconditioner_->post(x);
                 report_.setConverged(true);
                 return report_.converged();
             }
-            else if (convergenceCriterion_.failed()) {
+            else if (convergenceCriterion_->failed()) {
                 if (verbosity_ > 0) {
-                    convergenceCriterion_.print(report_.iterations() + 0.5);
+                    convergenceCriterion_->print(report_.iterations() + 0.5);
                     std::cout << "-------- /BiCGStabSolver --------" << std::endl;
                 }
 
@@ -273,43 +375,63 @@ public:
             }
 
             if (verbosity_ > 1)
-                convergenceCriterion_.print(report_.iterations() + 0.5);
+                convergenceCriterion_->print(report_.iterations() + 0.5);
 
             // z = K^-1*s
-            z = s;
-            preconditioner_.apply(z, s);
+            KrylovKernels::assign(z, s);
+            preconditioner_->apply(z, s);
 
             // t = Az
-            t = z;
+            KrylovKernels::assign(t, z);
             A_->apply(z, t);
 
             // omega_i = (t*s)/(t*t)
-            denom = scalarProduct_.dot(t, t);
+            Scalar ts;
+            std::array<Scalar, 4> fusedDots;
+            if (fuseReductions_) {
+                // (t, t), (t, s), (r0hat, s) and (r0hat, t)
+                dots_(fusedDots,
+                      std::array<const Vector*, 4>{{&t, &t, &r0hat, &r0hat}},
+                      std::array<const Vector*, 4>{{&t, &s, &s, &t}},
+                      /*preferFused=*/0);
+                denom = fusedDots[0];
+                ts = fusedDots[1];
+            }
+            else {
+                denom = scalarProduct_.dot(t, t);
+                ts = scalarProduct_.dot(t, s);
+            }
             if (std::abs(denom) <= breakdownEps)
                 throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (division by zero)");
-            omega = scalarProduct_.dot(t, s)/denom;
+            omega = ts/denom;
             if (std::abs(omega) <= breakdownEps)
                 throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (stagnation detected)");
 
+            if (fuseReductions_) {
+                // (r0hat, r_i) = (r0hat, s - omega_i*t) = (r0hat, s) - omega_i*(r0hat, t)
+                nextRho = fusedDots[2] - omega*fusedDots[3];
+                nextRhoValid = true;
+            }
+
             // x_i = h + omega_i*z
             // x = h; // not necessary because x and h are the same object
-            x.axpy(/*a=*/omega, /*y=*/z);
+            KrylovKernels::axpy(x, /*a=*/omega, /*y=*/z);
 
             // do convergence check and print terminal output
-            convergenceCriterion_.update(/*curSol=*/x, /*delta=*/z, r);
-            if (convergenceCriterion_.converged()) {
+            convergenceCriterion_->update(/*curSol=*/x, /*delta=*/z, r);
+            if (convergenceCriterion_->converged()) {
                 if (verbosity_ > 0) {
-                    convergenceCriterion_.print(1.0 + report_.iterations());
+                    convergenceCriterion_->print(1.0 + report_.iterations());
                     std::cout << "-------- /BiCGStabSolver --------" << std::endl;
                 }
 
-                preconditioner_.post(x);
+                preconditioner_->post(x);
                 report_.setConverged(true);
                 return report_.converged();
             }
-            else if (convergenceCriterion_.failed()) {
+            else if (convergenceCriterion_->failed()) {
                 if (verbosity_ > 0) {
-                    convergenceCriterion_.print(1.0 + report_.iterations());
+                    convergenceCriterion_->print(1.0 + report_.iterations());
                     std::cout << "-------- /BiCGStabSolver --------" << std::endl;
                 }
 
@@ -318,11 +440,11 @@ public:
             }
 
             if (verbosity_ > 1)
-                convergenceCriterion_.print(1.0 + report_.iterations());
+                convergenceCriterion_->print(1.0 + report_.iterations());
 
             // r_i = s - omega*t
             // r = s; // not necessary because r and s are the same object
-            r.axpy(/*a=*/-omega, /*y=*/t);
+            KrylovKernels::axpy(r, /*a=*/-omega, /*y=*/t);
         }
 
         report_.setConverged(false);
@@ -338,16 +460,39 @@ public:
     { return report_; }
 
 private:
+    // compute several scalar products using a single global reduction if the scalar
+    // product supports this...
+    template <size_t numDots, class SP = ScalarProduct>
+    auto dots_(std::array<Scalar, numDots>& result,
+               const std::array<const Vector*, numDots>& x,
+               const std::array<const Vector*, numDots>& y,
+               int preferFused OPM_UNUSED)
+        -> decltype(std::declval<SP&>().dots(result, x, y))
+    { return scalarProduct_.dots(result, x, y); }
+
+    // ... or one after another if it does not
+    template <size_t numDots>
+    void dots_(std::array<Scalar, numDots>& result,
+               const std::array<const Vector*, numDots>& x,
+               const std::array<const Vector*, numDots>& y,
+               long preferFused OPM_UNUSED)
+    {
+        for (size_t dotIdx = 0; dotIdx < numDots; ++dotIdx)
+            result[dotIdx] = scalarProduct_.dot(*x[dotIdx], *y[dotIdx]);
+    }
+
     const LinearOperator* A_;
     const Vector* b_;
+    Workspace* workspace_;
 
-    Preconditioner& preconditioner_;
-    ConvergenceCriterion& convergenceCriterion_;
-    Dune::ScalarProduct<Vector>& scalarProduct_;
+    Preconditioner* preconditioner_;
+    ConvergenceCriterion* convergenceCriterion_;
+    ScalarProduct& scalarProduct_;
     Opm::Linear::SolverReport report_;
 
     unsigned maxIterations_;
     unsigned verbosity_;
+    bool fuseReductions_;
 };
 
 } // namespace Linear
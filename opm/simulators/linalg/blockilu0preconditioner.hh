@@ -0,0 +1,388 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::BlockIlu0Preconditioner
+ */
+#ifndef EWOMS_BLOCK_ILU0_PRECONDITIONER_HH
+#define EWOMS_BLOCK_ILU0_PRECONDITIONER_HH
+
+#include "matrixblock.hh"
+
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/istlexception.hh>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/version.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A block ILU(0) preconditioner which uses its own storage for the
+ *        factorization.
+ *
+ * The factorization is stored in a contiguous block-CSR layout which is separated
+ * into the strictly lower part, the strictly upper part and the inverses of the
+ * diagonal blocks. Since the size of the blocks is a template parameter, all block
+ * operations are loops of constant length which the compiler fully unrolls for the
+ * block sizes used by the models (i.e., one to six equations).
+ *
+ * The rows are grouped into levels such that the rows of a level only depend on rows
+ * of previous levels. (The levels of the forward and the backward substitution are
+ * determined separately.) The rows of a level are processed in parallel if OpenMP is
+ * enabled and the level is large enough for this to pay off. Since the
+ * factorization of a row only depends on the rows of its lower part, it uses the
+ * levels of the forward substitution.
+ *
+ * The results are the same as the ones of the ILU(0) preconditioner of dune-istl up to
+ * rounding errors.
+ *
+ * The floating point type used to compute and to store the factorization can be
+ * different from the one of the matrix. Using single precision for the factors halves
+ * the amount of memory which needs to be read for each application of the
+ * preconditioner, while the vectors and the arithmetic of the substitutions keep the
+ * precision of the vectors.
+ */
+template <class Matrix, class DomainVector, class RangeVector,
+          class FactorScalar = typename Matrix::field_type>
+class BlockIlu0Preconditioner
+    : public Dune::Preconditioner<DomainVector, RangeVector>
+{
+    typedef typename Matrix::field_type Scalar;
+    enum { blockSize = Matrix::block_type::rows };
+    static_assert(static_cast<int>(Matrix::block_type::cols) == blockSize,
+                  "The blocks of the matrix must be quadratic");
+
+    typedef Dune::FieldMatrix<FactorScalar, blockSize, blockSize> Block;
+
+public:
+    typedef DomainVector domain_type;
+    typedef RangeVector range_type;
+    typedef typename DomainVector::field_type field_type;
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,6)
+    //! the kind of computations supported by the preconditioner.
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+#else
+    // redefine the category
+    enum { category = Dune::SolverCategory::sequential };
+#endif
+
+    BlockIlu0Preconditioner(const Matrix& A, Scalar relaxationFactor)
+        : relaxationFactor_(relaxationFactor)
+    { update(A); }
+
+    /*!
+     * \brief Compute the factorization for new matrix.
+     *
+     * The memory which has been allocated for previous factorizations is reused if
+     * the new one fits into it.
+     */
+    void update(const Matrix& A)
+    {
+        copyMatrix_(A);
+        computeLevels_();
+        factorize_();
+    }
+
+    /*!
+     * \brief Prepare the preconditioner.
+     */
+    void pre(DomainVector&, RangeVector&) override
+    {}
+
+    /*!
+     * \brief Apply one step of the preconditioner to the system A(v)=d.
+     */
+    void apply(DomainVector& v, const RangeVector& d) override
+    {
+        // forward substitution: v = L^-1 d, where L has unit diagonal blocks
+        forEachRow_(lowerLevelStart_, lowerLevelRows_, [&](size_t rowIdx) {
+                auto& vBlock = v[rowIdx];
+                for (unsigned i = 0; i < blockSize; ++i)
+                    vBlock[i] = d[rowIdx][i];
+
+                for (size_t k = rowStart_[rowIdx]; k < diagPos_[rowIdx]; ++k)
+                    mmv_(values_[k], v[colIdx_[k]], vBlock);
+            });
+
+        // backward substitution: v = U^-1 v
+        forEachRow_(upperLevelStart_, upperLevelRows_, [&](size_t rowIdx) {
+                auto vBlock = v[rowIdx];
+                for (size_t k = diagPos_[rowIdx] + 1; k < rowStart_[rowIdx + 1]; ++k)
+                    mmv_(values_[k], v[colIdx_[k]], vBlock);
+
+                mv_(diagInv_[rowIdx], vBlock, v[rowIdx]);
+            });
+
+        if (relaxationFactor_ != 1.0)
+            v *= relaxationFactor_;
+    }
+
+    /*!
+     * \brief Clean up.
+     */
+    void post(DomainVector&) override
+    {}
+
+private:
+    // copy the structure and the values of a BCRS matrix into our own storage
+    void copyMatrix_(const Matrix& A)
+    {
+        size_t numRows = A.N();
+        rowStart_.resize(numRows + 1);
+        diagPos_.resize(numRows);
+        colIdx_.resize(A.nonzeroes());
+        values_.resize(A.nonzeroes());
+        diagInv_.resize(numRows);
+
+        size_t pos = 0;
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            rowStart_[rowIdx] = pos;
+            diagPos_[rowIdx] = static_cast<size_t>(-1);
+
+            const auto& row = A[rowIdx];
+            const auto& colEndIt = row.end();
+            for (auto colIt = row.begin(); colIt != colEndIt; ++colIt, ++pos) {
+                colIdx_[pos] = colIt.index();
+                const auto& srcBlock = *colIt;
+                Block& destBlock = values_[pos];
+                for (unsigned i = 0; i < blockSize; ++i)
+                    for (unsigned j = 0; j < blockSize; ++j)
+                        destBlock[i][j] = static_cast<FactorScalar>(srcBlock[i][j]);
+                if (colIt.index() == rowIdx)
+                    diagPos_[rowIdx] = pos;
+            }
+
+            if (diagPos_[rowIdx] == static_cast<size_t>(-1))
+                DUNE_THROW(Dune::ISTLError,
+                           "The ILU(0) preconditioner requires all diagonal entries of the "
+                           "matrix to be present (row " << rowIdx << " lacks one)");
+        }
+        rowStart_[numRows] = pos;
+    }
+
+    // group the rows into levels for the forward and the backward substitutions
+    void computeLevels_()
+    {
+        size_t numRows = diagPos_.size();
+        rowLevel_.resize(numRows);
+
+        // forward substitution: the level of a row is one larger than the maximum
+        // level of the rows in its lower part
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            size_t level = 0;
+            for (size_t k = rowStart_[rowIdx]; k < diagPos_[rowIdx]; ++k)
+                level = std::max(level, rowLevel_[colIdx_[k]] + 1);
+            rowLevel_[rowIdx] = level;
+        }
+        sortRowsByLevel_(lowerLevelStart_, lowerLevelRows_);
+
+        // backward substitution: the same for the upper part, starting with the last row
+        for (size_t rowIdx = numRows; rowIdx-- > 0; ) {
+            size_t level = 0;
+            for (size_t k = diagPos_[rowIdx] + 1; k < rowStart_[rowIdx + 1]; ++k)
+                level = std::max(level, rowLevel_[colIdx_[k]] + 1);
+            rowLevel_[rowIdx] = level;
+        }
+        sortRowsByLevel_(upperLevelStart_, upperLevelRows_);
+    }
+
+    // convert the levels of all rows to a CSR-like list of the rows of each level
+    void sortRowsByLevel_(std::vector<size_t>& levelStart, std::vector<size_t>& levelRows)
+    {
+        size_t numRows = rowLevel_.size();
+        size_t numLevels = 0;
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            numLevels = std::max(numLevels, rowLevel_[rowIdx] + 1);
+
+        levelStart.assign(numLevels + 1, 0);
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            ++ levelStart[rowLevel_[rowIdx] + 1];
+        for (size_t levelIdx = 0; levelIdx < numLevels; ++levelIdx)
+            levelStart[levelIdx + 1] += levelStart[levelIdx];
+
+        // the rows of each level are stored in ascending order, so the memory is
+        // accessed as regularly as possible
+        levelRows.resize(numRows);
+        nextPos_.assign(levelStart.begin(), levelStart.end() - 1);
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            levelRows[nextPos_[rowLevel_[rowIdx]]++] = rowIdx;
+    }
+
+    // compute the ILU(0) factorization in place
+    void factorize_()
+    {
+        int failed = 0;
+        forEachRow_(lowerLevelStart_, lowerLevelRows_, [&](size_t rowIdx) {
+                size_t rowEnd = rowStart_[rowIdx + 1];
+                for (size_t ij = rowStart_[rowIdx]; ij < diagPos_[rowIdx]; ++ij) {
+                    size_t j = colIdx_[ij];
+
+                    // L_ij = A_ij * (U_jj)^-1
+                    Block tmp(values_[ij]);
+                    mm_(tmp, diagInv_[j], values_[ij]);
+
+                    // A_ik -= L_ij * U_jk for all k > j which are present in row i.
+                    // since the columns are sorted, rows i and j can be merged.
+                    size_t ik = ij + 1;
+                    size_t jk = diagPos_[j] + 1;
+                    size_t jEnd = rowStart_[j + 1];
+                    while (ik < rowEnd && jk < jEnd) {
+                        if (colIdx_[ik] < colIdx_[jk])
+                            ++ik;
+                        else if (colIdx_[jk] < colIdx_[ik])
+                            ++jk;
+                        else {
+                            mmm_(values_[ij], values_[jk], values_[ik]);
+                            ++ik;
+                            ++jk;
+                        }
+                    }
+                }
+
+                Block& diagInv = diagInv_[rowIdx];
+                diagInv = values_[diagPos_[rowIdx]];
+                try {
+                    Opm::MatrixBlockHelp::invertMatrix(diagInv);
+                }
+                catch (...) {
+                    // exceptions must not escape from OpenMP parallel regions
+                    markFailed_(failed);
+                    return;
+                }
+                for (unsigned i = 0; i < blockSize; ++i)
+                    for (unsigned j = 0; j < blockSize; ++j)
+                        if (!std::isfinite(diagInv[i][j]))
+                            markFailed_(failed);
+            });
+
+        if (failed)
+            DUNE_THROW(Dune::MatrixBlockError,
+                       "A diagonal block of the ILU(0) factorization is singular");
+    }
+
+    // call a function for each row, processing the levels one after another. the rows
+    // of a level are processed in parallel.
+    template <class Fn>
+    void forEachRow_(const std::vector<size_t>& levelStart,
+                     const std::vector<size_t>& levelRows,
+                     const Fn& fn) const
+    {
+        size_t numLevels = levelStart.size() - 1;
+        for (size_t levelIdx = 0; levelIdx < numLevels; ++levelIdx) {
+            const long begin = static_cast<long>(levelStart[levelIdx]);
+            const long end = static_cast<long>(levelStart[levelIdx + 1]);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (end - begin >= long(minRowsPerThreadedLevel))
+#endif
+            for (long i = begin; i < end; ++i)
+                fn(levelRows[static_cast<size_t>(i)]);
+        }
+    }
+
+    static void markFailed_(int& failed)
+    {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+        failed = 1;
+    }
+
+    // y -= A*x for a block and two vector blocks
+    template <class X, class Y>
+    static void mmv_(const Block& A, const X& x, Y& y)
+    {
+        for (unsigned i = 0; i < blockSize; ++i)
+            for (unsigned j = 0; j < blockSize; ++j)
+                y[i] -= A[i][j]*x[j];
+    }
+
+    // y = A*x for a block and two vector blocks
+    template <class X, class Y>
+    static void mv_(const Block& A, const X& x, Y& y)
+    {
+        for (unsigned i = 0; i < blockSize; ++i) {
+            field_type tmp = 0.0;
+            for (unsigned j = 0; j < blockSize; ++j)
+                tmp += A[i][j]*x[j];
+            y[i] = tmp;
+        }
+    }
+
+    // C = A*B for three blocks
+    static void mm_(const Block& A, const Block& B, Block& C)
+    {
+        for (unsigned i = 0; i < blockSize; ++i) {
+            for (unsigned j = 0; j < blockSize; ++j) {
+                FactorScalar tmp = 0.0;
+                for (unsigned k = 0; k < blockSize; ++k)
+                    tmp += A[i][k]*B[k][j];
+                C[i][j] = tmp;
+            }
+        }
+    }
+
+    // C -= A*B for three blocks
+    static void mmm_(const Block& A, const Block& B, Block& C)
+    {
+        for (unsigned i = 0; i < blockSize; ++i)
+            for (unsigned j = 0; j < blockSize; ++j)
+                for (unsigned k = 0; k < blockSize; ++k)
+                    C[i][j] -= A[i][k]*B[k][j];
+    }
+
+    static constexpr size_t minRowsPerThreadedLevel = 256;
+
+    Scalar relaxationFactor_;
+
+    // the factorization. the lower part of row i is stored at the positions
+    // [rowStart_[i], diagPos_[i]), the upper part at (diagPos_[i], rowStart_[i + 1])
+    std::vector<size_t> rowStart_;
+    std::vector<size_t> diagPos_;
+    std::vector<size_t> colIdx_;
+    std::vector<Block> values_;
+    std::vector<Block> diagInv_;
+
+    // the rows of the levels of the forward and the backward substitutions
+    std::vector<size_t> lowerLevelStart_;
+    std::vector<size_t> lowerLevelRows_;
+    std::vector<size_t> upperLevelStart_;
+    std::vector<size_t> upperLevelRows_;
+
+    // temporary arrays used to determine the levels
+    std::vector<size_t> rowLevel_;
+    std::vector<size_t> nextPos_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -28,6 +28,7 @@
 #define EWOMS_COMBINED_CRITERION_HH
 
 #include "convergencecriterion.hh"
+#include "krylovkernels.hh"
 
 #include <iostream>
 
@@ -188,24 +189,35 @@ private:
     void updateErrors_(const Vector& curSol OPM_UNUSED, const Vector& changeIndicator,  const Vector& curResid)
     {
         lastResidualError_ = residualError_;
-        residualError_ = 0.0;
-        stagnates_ = true;
-        for (size_t i = 0; i < curResid.size(); ++i) {
+
+        // the maximum norm is insensitive to the entries which are shared with other
+        // processes, so all local rows can be considered.
+        Scalar residualError = 0.0;
+        int doesNotStagnate = 0;
+        const long n = static_cast<long>(curResid.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(max: residualError, doesNotStagnate) \
+    if (n >= long(KrylovKernels::minRowsPerThreadedKernel))
+#endif
+        for (long i = 0; i < n; ++i) {
             for (unsigned j = 0; j < BlockType::dimension; ++j) {
-                residualError_ =
-                    std::max<Scalar>(residualError_,
+                residualError =
+                    std::max<Scalar>(residualError,
                                      std::abs(curResid[i][j]));
 
-                if (stagnates_ && changeIndicator[i][j] != 0.0)
+                if (changeIndicator[i][j] != 0.0)
                     // only stagnation means that we've failed!
-                    stagnates_ = false;
+                    doesNotStagnate = 1;
             }
         }
 
-        residualError_ = comm_.max(residualError_);
-
-        // the linear solver only stagnates if all processes stagnate
-        stagnates_ = comm_.min(stagnates_);
+        // the linear solver only stagnates if all processes stagnate. to get away with
+        // a single global reduction, this is determined as the maximum of the "does not
+        // stagnate" flags of the processes.
+        Scalar reduced[2] = { residualError, Scalar(doesNotStagnate) };
+        comm_.max(reduced, 2);
+        residualError_ = reduced[0];
+        stagnates_ = (reduced[1] == 0.0);
     }
 
     const CollectiveCommunication& comm_;
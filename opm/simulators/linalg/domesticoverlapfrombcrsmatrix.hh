@@ -87,6 +87,7 @@ public:
         blackList_.updateNativeToDomesticMap(*this);
 
         setupDebugMapping_();
+        updateMasterIndices_();
     }
 
     void check() const
@@ -256,6 +257,17 @@ public:
         return foreignOverlap_.iAmMasterOf(mapExternalToInternal_(domesticIdx));
     }
 
+    /*!
+     * \brief Returns the domestic indices of which the current process is the
+     *        master in ascending order.
+     *
+     * This is the set of indices for which iAmMasterOf() returns true. It is intended
+     * for loops which must consider each index exactly once in the global system,
+     * e.g. scalar products.
+     */
+    const std::vector<Index>& masterIndices() const
+    { return masterIndices_; }
+
     /*!
      * \brief Return the rank of a master process for a domestic index
      */
@@ -546,6 +558,14 @@ protected:
     void setupDebugMapping_()
     {}
 
+    void updateMasterIndices_()
+    {
+        masterIndices_.clear();
+        for (Index domesticIdx = 0; domesticIdx < static_cast<Index>(numLocal()); ++domesticIdx)
+            if (iAmMasterOf(domesticIdx))
+                masterIndices_.push_back(domesticIdx);
+    }
+
     // this method is intended to map domestic indices to the ones
     // used by a sequential grid.
     //
@@ -570,6 +590,7 @@ protected:
     OverlapByIndex domesticOverlapByIndex_;
     std::vector<BorderDistance> borderDistance_;
     std::vector<ProcessRank> masterRank_;
+    std::vector<Index> masterIndices_;
 
     std::map<ProcessRank, MpiBuffer<size_t> *> numIndicesSendBuffer_;
     std::map<ProcessRank, MpiBuffer<IndexDistanceNpeers> *> indicesSendBuffer_;
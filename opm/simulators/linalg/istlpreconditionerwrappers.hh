@@ -39,17 +39,23 @@
  * - \c SOR: A successive overrelaxation (SOR) preconditioner
  * - \c ILUn: An ILU(n) preconditioner
  * - \c ILU0: A specialized (and optimized) ILU(0) preconditioner
+ * - \c BlockILU0: A block ILU(0) preconditioner which does not use dune-istl for the
+ *                 factorization and which can use multiple threads. Its factors are
+ *                 stored using the PreconditionerScalar property.
  */
 #ifndef EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 #define EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
+#include <opm/simulators/linalg/blockilu0preconditioner.hh>
 
 #include <dune/istl/preconditioners.hh>
 
 #include <dune/common/version.hh>
 
+#include <memory>
+
 BEGIN_PROPERTIES
 NEW_PROP_TAG(Scalar);
 NEW_PROP_TAG(SparseMatrixAdapter);
@@ -57,6 +63,7 @@ NEW_PROP_TAG(OverlappingMatrix);
 NEW_PROP_TAG(OverlappingVector);
 NEW_PROP_TAG(PreconditionerOrder);
 NEW_PROP_TAG(PreconditionerRelaxation);
+NEW_PROP_TAG(PreconditionerScalar);
 END_PROPERTIES
 
 namespace Opm {
@@ -66,12 +73,12 @@ namespace Linear {
     class PreconditionerWrapper##PREC_NAME                                      \
     {                                                                           \
         typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;                 \
-        typedef typename GET_PROP_TYPE(TypeTag, SparseMatrixAdapter) SparseMatrixAdapter; \
-        typedef typename SparseMatrixAdapter::IstlMatrix IstlMatrix;            \
+        typedef typename GET_PROP_TYPE(TypeTag, OverlappingMatrix) OverlappingMatrix; \
+        typedef typename OverlappingMatrix::NonOverlappingMatrix Matrix;        \
         typedef typename GET_PROP_TYPE(TypeTag, OverlappingVector) OverlappingVector; \
                                                                                 \
     public:                                                                     \
-        typedef ISTL_PREC_TYPE<IstlMatrix, OverlappingVector,                   \
+        typedef ISTL_PREC_TYPE<Matrix, OverlappingVector,                       \
                                OverlappingVector> SequentialPreconditioner;     \
         PreconditionerWrapper##PREC_NAME()                                      \
         {}                                                                      \
@@ -85,7 +92,7 @@ namespace Linear {
                                  "preconditioner");                             \
         }                                                                       \
                                                                                 \
-        void prepare(IstlMatrix& matrix)                                        \
+        void prepare(const Matrix& matrix)                                      \
         {                                                                       \
             int order = EWOMS_GET_PARAM(TypeTag, int, PreconditionerOrder);     \
             Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);   \
@@ -111,10 +118,11 @@ namespace Linear {
     {                                                                           \
         typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;                 \
         typedef typename GET_PROP_TYPE(TypeTag, OverlappingMatrix) OverlappingMatrix; \
+        typedef typename OverlappingMatrix::NonOverlappingMatrix Matrix;        \
         typedef typename GET_PROP_TYPE(TypeTag, OverlappingVector) OverlappingVector; \
                                                                                 \
     public:                                                                     \
-        typedef ISTL_PREC_TYPE<OverlappingMatrix, OverlappingVector,            \
+        typedef ISTL_PREC_TYPE<Matrix, OverlappingVector,                       \
                                OverlappingVector> SequentialPreconditioner;     \
         PreconditionerWrapper##PREC_NAME()                                      \
         {}                                                                      \
@@ -126,7 +134,7 @@ namespace Linear {
                                  "preconditioner");                             \
         }                                                                       \
                                                                                 \
-        void prepare(OverlappingMatrix& matrix)                                 \
+        void prepare(const Matrix& matrix)                                      \
         {                                                                       \
             Scalar relaxationFactor =                                           \
                 EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);     \
@@ -159,12 +167,13 @@ class PreconditionerWrapperILU
 {
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, OverlappingMatrix) OverlappingMatrix;
+    typedef typename OverlappingMatrix::NonOverlappingMatrix Matrix;
     typedef typename GET_PROP_TYPE(TypeTag, OverlappingVector) OverlappingVector;
 
     static constexpr int order = GET_PROP_VALUE(TypeTag, PreconditionerOrder);
 
 public:
-    typedef Dune::SeqILU<OverlappingMatrix, OverlappingVector, OverlappingVector, order>
+    typedef Dune::SeqILU<Matrix, OverlappingVector, OverlappingVector, order>
            SequentialPreconditioner;
 
     PreconditionerWrapperILU()
@@ -176,7 +185,7 @@ public:
                              "The relaxation factor of the preconditioner");
     }
 
-    void prepare(OverlappingMatrix& matrix)
+    void prepare(const Matrix& matrix)
     {
         Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
 
@@ -199,6 +208,56 @@ EWOMS_WRAP_ISTL_SIMPLE_PRECONDITIONER(ILU0, Dune::SeqILU0)
 EWOMS_WRAP_ISTL_PRECONDITIONER(ILUn, Dune::SeqILUn)
 #endif
 
+/*!
+ * \brief Wraps the native block ILU(0) preconditioner.
+ *
+ * In contrast to the other wrappers, the preconditioner object is kept across linear
+ * solves, so the memory of its factorization is reused.
+ */
+template <class TypeTag>
+class PreconditionerWrapperBlockILU0
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingMatrix) OverlappingMatrix;
+    typedef typename OverlappingMatrix::NonOverlappingMatrix Matrix;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingVector) OverlappingVector;
+    typedef typename GET_PROP_TYPE(TypeTag, PreconditionerScalar) PreconditionerScalar;
+
+public:
+    typedef Opm::Linear::BlockIlu0Preconditioner<Matrix,
+                                                 OverlappingVector,
+                                                 OverlappingVector,
+                                                 PreconditionerScalar> SequentialPreconditioner;
+
+    PreconditionerWrapperBlockILU0()
+    {}
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PreconditionerRelaxation,
+                             "The relaxation factor of the preconditioner");
+    }
+
+    void prepare(const Matrix& matrix)
+    {
+        if (seqPreCond_)
+            seqPreCond_->update(matrix);
+        else {
+            Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
+            seqPreCond_.reset(new SequentialPreconditioner(matrix, relaxationFactor));
+        }
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { /* the factorization is kept for the next linear solve */ }
+
+private:
+    std::unique_ptr<SequentialPreconditioner> seqPreCond_;
+};
+
 #undef EWOMS_WRAP_ISTL_PRECONDITIONER
 }} // namespace Linear, Ewoms
 
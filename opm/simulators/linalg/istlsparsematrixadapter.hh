@@ -27,6 +27,8 @@
 #ifndef EWOMS_ISTL_SPARSE_MATRIX_ADAPTER_HH
 #define EWOMS_ISTL_SPARSE_MATRIX_ADAPTER_HH
 
+#include <opm/simulators/linalg/sparsitypattern.hh>
+
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
@@ -100,6 +102,34 @@ public:
         istlMatrix_->endindices();
     }
 
+    /*!
+     * \brief Allocate matrix structure given a finalized sparsity pattern in compressed
+     *        row storage format.
+     */
+    void reserve(const SparsityPattern& sparsityPattern)
+    {
+        // allocate raw matrix
+        istlMatrix_.reset(new IstlMatrix(rows_, columns_, IstlMatrix::random));
+
+        // make sure sparsityPattern is consistent with number of rows
+        assert(rows_ == sparsityPattern.numRows());
+
+        // allocate space for the rows of the matrix
+        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx)
+            istlMatrix_->setrowsize(dofIdx, sparsityPattern.rowSize(dofIdx));
+
+        istlMatrix_->endrowsizes();
+
+        // fill the rows with the column indices
+        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx) {
+            const unsigned* colIt = sparsityPattern.rowBegin(dofIdx);
+            const unsigned* colEndIt = sparsityPattern.rowEnd(dofIdx);
+            for (; colIt != colEndIt; ++colIt)
+                istlMatrix_->addindex(dofIdx, *colIt);
+        }
+        istlMatrix_->endindices();
+    }
+
     /*!
      * \brief Return constant reference to matrix implementation.
      */
@@ -161,6 +191,16 @@ public:
     void setBlock(const size_t rowIdx, const size_t colIdx, const MatrixBlock& value)
     { (*istlMatrix_)[rowIdx][colIdx] = value; }
 
+    /*!
+     * \brief Return the address of a block of the matrix.
+     *
+     * The address stays valid until the sparsity pattern is changed, i.e., until
+     * reserve() is called again. Note that the block must be part of the sparsity
+     * pattern of the matrix.
+     */
+    MatrixBlock* blockAddress(const size_t rowIdx, const size_t colIdx)
+    { return &(*istlMatrix_)[rowIdx][colIdx]; }
+
     /*!
      * \brief Add block to matrix block.
      */
@@ -0,0 +1,229 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::KrylovKernels
+ */
+#ifndef EWOMS_KRYLOV_KERNELS_HH
+#define EWOMS_KRYLOV_KERNELS_HH
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief The vector operations which are required by the Krylov subspace solvers.
+ *
+ * Each kernel does a single pass over the rows of the involved block vectors. The
+ * rows are distributed over the OpenMP threads if the vectors are large enough for
+ * this to pay off, and the innermost loops run over the entries of a single block
+ * with a size that is known at compile time, so the compiler is able to vectorize
+ * them.
+ *
+ * If scalar products are computed using multiple threads, the partial sums of the
+ * threads are added up in the order of the thread indices. The results thus are
+ * reproducible for a given number of threads, but the rounding errors may depend on
+ * the number of threads.
+ */
+class KrylovKernels
+{
+public:
+    /*!
+     * \brief The minimum number of rows of a vector for which the work is distributed
+     *        over multiple threads.
+     */
+    static constexpr size_t minRowsPerThreadedKernel = 4096;
+
+    /*!
+     * \brief Copy the entries of a vector to another one.
+     *
+     * In contrast to the assignment operator, this only touches the entries of the
+     * vectors, i.e., additional state like communication buffers is left alone.
+     */
+    template <class Vector>
+    static void assign(Vector& dest, const Vector& src)
+    {
+        assert(dest.size() == src.size());
+
+        const long n = static_cast<long>(src.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (n >= long(minRowsPerThreadedKernel))
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx)
+            dest[rowIdx] = src[rowIdx];
+    }
+
+    /*!
+     * \brief Compute x += a*y.
+     */
+    template <class Vector, class Scalar>
+    static void axpy(Vector& x, Scalar a, const Vector& y)
+    {
+        assert(x.size() == y.size());
+
+        const long n = static_cast<long>(x.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (n >= long(minRowsPerThreadedKernel))
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx) {
+            auto& xBlock = x[rowIdx];
+            const auto& yBlock = y[rowIdx];
+            for (size_t k = 0; k < blockSize_<Vector>(); ++k)
+                xBlock[k] += a*yBlock[k];
+        }
+    }
+
+    /*!
+     * \brief Update the search direction of the BiCGStab method.
+     *
+     * This computes p = r + beta*(p - omega*v).
+     */
+    template <class Vector, class Scalar>
+    static void bicgstabSearchDirection(Vector& p,
+                                        const Vector& r,
+                                        const Vector& v,
+                                        Scalar beta,
+                                        Scalar omega)
+    {
+        assert(p.size() == r.size() && p.size() == v.size());
+
+        const long n = static_cast<long>(p.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (n >= long(minRowsPerThreadedKernel))
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx) {
+            auto& pBlock = p[rowIdx];
+            const auto& rBlock = r[rowIdx];
+            const auto& vBlock = v[rowIdx];
+            for (size_t k = 0; k < blockSize_<Vector>(); ++k)
+                pBlock[k] = rBlock[k] + beta*(pBlock[k] - omega*vBlock[k]);
+        }
+    }
+
+    /*!
+     * \brief Compute the intermediate solution and residual of a BiCGStab iteration.
+     *
+     * This computes h = h + alpha*y and s = s - alpha*v.
+     */
+    template <class Vector, class Scalar>
+    static void bicgstabIntermediate(Vector& h,
+                                     Vector& s,
+                                     const Vector& y,
+                                     const Vector& v,
+                                     Scalar alpha)
+    {
+        assert(h.size() == s.size() && h.size() == y.size() && h.size() == v.size());
+
+        const long n = static_cast<long>(h.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (n >= long(minRowsPerThreadedKernel))
+#endif
+        for (long rowIdx = 0; rowIdx < n; ++rowIdx) {
+            auto& hBlock = h[rowIdx];
+            auto& sBlock = s[rowIdx];
+            const auto& yBlock = y[rowIdx];
+            const auto& vBlock = v[rowIdx];
+            for (size_t k = 0; k < blockSize_<Vector>(); ++k) {
+                hBlock[k] += alpha*yBlock[k];
+                sBlock[k] -= alpha*vBlock[k];
+            }
+        }
+    }
+
+    /*!
+     * \brief Compute the local contributions to several scalar products in a single
+     *        pass.
+     *
+     * Only the rows contained in 'rowIndices' are considered. On return, the i-th
+     * entry of 'result' is the partial scalar product of the vectors pointed to by x[i]
+     * and y[i].
+     */
+    template <size_t numDots, class Vector, class Scalar, class IndexVector>
+    static void dots(std::array<Scalar, numDots>& result,
+                     const std::array<const Vector*, numDots>& x,
+                     const std::array<const Vector*, numDots>& y,
+                     const IndexVector& rowIndices)
+    {
+        const long n = static_cast<long>(rowIndices.size());
+
+        // the partial sums of each thread are stored separately and added up in the
+        // order of the thread indices afterwards, so the result is reproducible for a
+        // given number of threads
+        int numThreads = 1;
+#ifdef _OPENMP
+        if (n >= long(minRowsPerThreadedKernel))
+            numThreads = omp_get_max_threads();
+#endif
+        std::vector<std::array<Scalar, numDots> > threadPartials(static_cast<size_t>(numThreads));
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads)
+#endif
+        {
+            std::array<Scalar, numDots> partial;
+            partial.fill(0.0);
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (long i = 0; i < n; ++i) {
+                const auto rowIdx = rowIndices[i];
+                for (size_t dotIdx = 0; dotIdx < numDots; ++dotIdx) {
+                    const auto& xBlock = (*x[dotIdx])[rowIdx];
+                    const auto& yBlock = (*y[dotIdx])[rowIdx];
+                    for (size_t k = 0; k < blockSize_<Vector>(); ++k)
+                        partial[dotIdx] += xBlock[k]*yBlock[k];
+                }
+            }
+
+            size_t threadId = 0;
+#ifdef _OPENMP
+            threadId = static_cast<size_t>(omp_get_thread_num());
+#endif
+            threadPartials[threadId] = partial;
+        }
+
+        result.fill(0.0);
+        for (const auto& partial : threadPartials)
+            for (size_t dotIdx = 0; dotIdx < numDots; ++dotIdx)
+                result[dotIdx] += partial[dotIdx];
+    }
+
+private:
+    template <class Vector>
+    static constexpr size_t blockSize_()
+    { return Vector::block_type::dimension; }
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
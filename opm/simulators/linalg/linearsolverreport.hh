@@ -47,22 +47,39 @@ public:
     void reset()
     {
         timer_.halt();
+        setupTimer_.halt();
         iterations_ = 0;
         converged_ = 0;
+        preconditionerReused_ = false;
     }
 
+    /*!
+     * \brief The timer for the iterations of the linear solver.
+     */
     const Opm::Timer& timer() const
     { return timer_; }
 
     Opm::Timer& timer()
     { return timer_; }
 
+    /*!
+     * \brief The timer for setting up the preconditioner.
+     */
+    const Opm::Timer& setupTimer() const
+    { return setupTimer_; }
+
+    Opm::Timer& setupTimer()
+    { return setupTimer_; }
+
     unsigned iterations() const
     { return iterations_; }
 
     void increment()
     { ++iterations_; }
 
+    void setIterations(unsigned value)
+    { iterations_ = value; }
+
     SolverReport& operator++()
     { ++iterations_; return *this; }
 
@@ -72,10 +89,22 @@ public:
     void setConverged(bool value)
     { converged_ = value; }
 
+    /*!
+     * \brief Returns true if the preconditioner of an earlier linear solve was used
+     *        without updating it.
+     */
+    bool preconditionerReused() const
+    { return preconditionerReused_; }
+
+    void setPreconditionerReused(bool value)
+    { preconditionerReused_ = value; }
+
 private:
     Opm::Timer timer_;
+    Opm::Timer setupTimer_;
     unsigned iterations_;
     bool converged_;
+    bool preconditionerReused_;
 };
 
 }} // end namespace Linear, Ewoms
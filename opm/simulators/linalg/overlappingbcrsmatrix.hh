@@ -30,6 +30,7 @@
 #include <opm/simulators/linalg/domesticoverlapfrombcrsmatrix.hh>
 #include <opm/simulators/linalg/globalindices.hh>
 #include <opm/simulators/linalg/blacklist.hh>
+#include <opm/simulators/linalg/krylovkernels.hh>
 #include <opm/models/parallel/mpibuffer.hh>
 
 #include <opm/material/common/Valgrind.hpp>
@@ -38,6 +39,7 @@
 #include <dune/istl/io.hh>
 
 #include <algorithm>
+#include <cassert>
 #include <set>
 #include <map>
 #include <iostream>
@@ -58,6 +60,9 @@ class OverlappingBCRSMatrix : public BCRSMatrix
 public:
     typedef Opm::Linear::DomesticOverlapFromBCRSMatrix Overlap;
 
+    //! the type of the sequential matrix which stores the entries of the process
+    typedef BCRSMatrix NonOverlappingMatrix;
+
 private:
     typedef std::vector<std::set<Index> > Entries;
 
@@ -70,13 +75,22 @@ public:
     // no real copying done at the moment
     OverlappingBCRSMatrix(const OverlappingBCRSMatrix& other)
         : ParentType(other)
+        , hasNativeLayout_(other.hasNativeLayout_)
     {}
 
+    /*!
+     * \brief Create the overlapping matrix for a non-overlapping one.
+     *
+     * If allocateIfNativeLayout is false and the overlapping matrix has the same layout
+     * as the native one (cf. hasNativeLayout()), the entries of the overlapping matrix
+     * are not allocated. In this case, the native matrix must be used in its place.
+     */
     template <class NativeBCRSMatrix>
     OverlappingBCRSMatrix(const NativeBCRSMatrix& nativeMatrix,
                           const BorderList& borderList,
                           const BlackList& blackList,
-                          unsigned overlapSize)
+                          unsigned overlapSize,
+                          bool allocateIfNativeLayout = true)
     {
         overlap_ = std::make_shared<Overlap>(nativeMatrix, borderList, blackList, overlapSize);
         myRank_ = 0;
@@ -84,9 +98,12 @@ public:
         MPI_Comm_rank(MPI_COMM_WORLD, &myRank_);
 #endif // HAVE_MPI
 
+        hasNativeLayout_ = computeHasNativeLayout_(nativeMatrix.N());
+
         // build the overlapping matrix from the non-overlapping
         // matrix and the overlap
-        build_(nativeMatrix);
+        if (!hasNativeLayout_ || allocateIfNativeLayout)
+            build_(nativeMatrix);
     }
 
     // this constructor is required to make the class compatible with the SeqILU class of
@@ -133,6 +150,17 @@ public:
     const Overlap& overlap() const
     { return *overlap_; }
 
+    /*!
+     * \brief Returns true if the overlapping matrix exhibits the same rows and entries as
+     *        the native matrix.
+     *
+     * This is the case if the process does not have any peers and if the domestic
+     * indices are the same as the native ones. Provided that the field types match, the
+     * native matrix can then be used instead of the overlapping one.
+     */
+    bool hasNativeLayout() const
+    { return hasNativeLayout_; }
+
     /*!
      * \brief Assign and syncronize the overlapping matrix from a non-overlapping one.
      */
@@ -217,14 +245,52 @@ public:
                                 "row");
     }
 
+    /*!
+     * \brief Copy the entries of a non-overlapping matrix to the overlapping one.
+     *
+     * Rows of the native matrix which have the same sparsity pattern as the
+     * corresponding row of the overlapping matrix (which is the case for all rows if
+     * there are no peer processes) are copied entry by entry without looking up the
+     * domestic indices. Only the remaining rows, i.e., the ones at the process borders,
+     * are zeroed and assembled using the index mapping of the overlap.
+     *
+     * Note that this method can only be used if the entries of the overlapping matrix
+     * have been allocated. If the matrix has the same layout as the native one, the
+     * copy can be avoided altogether by using the native matrix in its place.
+     */
     template <class NativeBCRSMatrix>
     void assignFromNative(const NativeBCRSMatrix& nativeMatrix)
     {
-        // first, set everything to 0,
-        BCRSMatrix::operator=(0.0);
+        assert(nativeRowIsAligned_.size() == nativeMatrix.N());
 
-        // then copy the domestic entries of the native matrix to the overlapping matrix
+        // first, copy the rows which are aligned
+        const long numNativeRows = static_cast<long>(nativeMatrix.N());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (numNativeRows >= long(KrylovKernels::minRowsPerThreadedKernel))
+#endif
+        for (long nativeRowIdx = 0; nativeRowIdx < numNativeRows; ++nativeRowIdx) {
+            if (!nativeRowIsAligned_[static_cast<size_t>(nativeRowIdx)])
+                continue;
+
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            auto destIt = (*this)[static_cast<unsigned>(domesticRowIdx)].begin();
+            auto srcIt = nativeMatrix[static_cast<unsigned>(nativeRowIdx)].begin();
+            const auto& srcEndIt = nativeMatrix[static_cast<unsigned>(nativeRowIdx)].end();
+            for (; srcIt != srcEndIt; ++srcIt, ++destIt)
+                copyBlock_(*destIt, *srcIt);
+        }
+
+        // then, set the remaining rows to 0,
+        size_t numDomestic = overlap_->numDomestic();
+        for (unsigned domesticRowIdx = 0; domesticRowIdx < numDomestic; ++domesticRowIdx)
+            if (!domesticRowIsAligned_[domesticRowIdx])
+                (*this)[domesticRowIdx] = 0.0;
+
+        // and copy the domestic entries of the native matrix to them
         for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+            if (nativeRowIsAligned_[nativeRowIdx])
+                continue; // the row has already been copied
+
             Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
             if (domesticRowIdx < 0) {
                 continue; // row corresponds to a black-listed entry
@@ -247,16 +313,8 @@ public:
                     // algebraic one...
                     continue;
 
-                // we need to copy the block matrices manually since it seems that (at
-                // least some versions of) Dune have an endless recursion bug when
-                // assigning dense matrices of different field type
-                const auto& src = *nativeColIt;
-                auto& dest = (*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
-                for (unsigned i = 0; i < src.rows; ++i) {
-                    for (unsigned j = 0; j < src.cols; ++j) {
-                        dest[i][j] = static_cast<field_type>(src[i][j]);
-                    }
-                }
+                copyBlock_((*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)],
+                           *nativeColIt);
             }
         }
     }
@@ -323,6 +381,18 @@ public:
     }
 
 private:
+    bool computeHasNativeLayout_(size_t numNativeRows) const
+    {
+        if (!overlap_->peerSet().empty() || overlap_->numDomestic() != numNativeRows)
+            return false;
+
+        for (size_t nativeIdx = 0; nativeIdx < numNativeRows; ++nativeIdx)
+            if (overlap_->nativeToDomestic(static_cast<Index>(nativeIdx)) != static_cast<Index>(nativeIdx))
+                return false;
+
+        return true;
+    }
+
     template <class NativeBCRSMatrix>
     void build_(const NativeBCRSMatrix& nativeMatrix)
     {
@@ -334,6 +404,58 @@ private:
 
         // communicate the entries
         buildIndices_(nativeMatrix);
+
+        // determine the rows which can be copied directly from the native matrix
+        findAlignedRows_(nativeMatrix);
+    }
+
+    // a row of the native matrix is aligned with its domestic row if the latter exhibits
+    // exactly the same entries in the same order. such rows can be copied without
+    // mapping the indices.
+    template <class NativeBCRSMatrix>
+    void findAlignedRows_(const NativeBCRSMatrix& nativeMatrix)
+    {
+        nativeRowIsAligned_.assign(nativeMatrix.N(), 0);
+        domesticRowIsAligned_.assign(overlap_->numDomestic(), 0);
+
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            if (domesticRowIdx < 0)
+                continue;
+
+            const auto& nativeRow = nativeMatrix[nativeRowIdx];
+            const auto& domesticRow = (*this)[static_cast<unsigned>(domesticRowIdx)];
+            if (nativeRow.size() != domesticRow.size())
+                continue;
+
+            bool isAligned = true;
+            auto domesticColIt = domesticRow.begin();
+            auto nativeColIt = nativeRow.begin();
+            const auto& nativeColEndIt = nativeRow.end();
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++domesticColIt) {
+                Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+                if (domesticColIdx < 0 || static_cast<size_t>(domesticColIdx) != domesticColIt.index()) {
+                    isAligned = false;
+                    break;
+                }
+            }
+
+            nativeRowIsAligned_[nativeRowIdx] = isAligned;
+            domesticRowIsAligned_[static_cast<unsigned>(domesticRowIdx)] = isAligned;
+        }
+    }
+
+    // we need to copy the block matrices manually since it seems that (at least some
+    // versions of) Dune have an endless recursion bug when assigning dense matrices of
+    // different field type
+    template <class NativeBlock>
+    static void copyBlock_(block_type& dest, const NativeBlock& src)
+    {
+        for (unsigned i = 0; i < src.rows; ++i) {
+            for (unsigned j = 0; j < src.cols; ++j) {
+                dest[i][j] = static_cast<field_type>(src[i][j]);
+            }
+        }
     }
 
     template <class NativeBCRSMatrix>
@@ -672,7 +794,13 @@ private:
 
     int myRank_;
     Entries entries_;
+
+    // specifies which rows of the native matrix and of the overlapping one can be copied
+    // without mapping the indices
+    std::vector<unsigned char> nativeRowIsAligned_;
+    std::vector<unsigned char> domesticRowIsAligned_;
     std::shared_ptr<Overlap> overlap_;
+    bool hasNativeLayout_;
 
     std::map<ProcessRank, MpiBuffer<unsigned> *> numRowsSendBuff_;
     std::map<ProcessRank, MpiBuffer<unsigned> *> rowSizesSendBuff_;
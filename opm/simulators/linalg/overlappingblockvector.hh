@@ -174,11 +174,31 @@ public:
      */
     void sync()
     {
-        // send all entries to all peers
-        for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+        syncBegin();
+        syncEnd();
+    }
+
+    /*!
+     * \brief Start to syncronize the values of the block vector from their master
+     *        process.
+     *
+     * This sends the values of all rows which are seen by peer processes, i.e., these
+     * rows must not be modified until syncEnd() was called. The values of all other
+     * rows may be modified in the meantime, but the values of the rows which are
+     * mastered by peer processes get overwritten by syncEnd().
+     *
+     * Since copies of a vector share their communication buffers, at most one
+     * synchronization may be in flight for a vector and all of its copies.
+     */
+    void syncBegin()
+    { startExchange_(); }
 
-        // recieve all entries to the peers
+    /*!
+     * \brief Finish the syncronization which was started by syncBegin().
+     */
+    void syncEnd()
+    {
+        // receive the entries from the peers
         for (const auto peerRank: overlap_->peerSet())
             receiveFromMaster_(peerRank);
 
@@ -192,11 +212,25 @@ public:
      */
     void syncAdd()
     {
-        // send all entries to all peers
-        for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+        syncAddBegin();
+        syncAddEnd();
+    }
 
-        // recieve all entries to the peers
+    /*!
+     * \brief Start to syncronize the values of the block vector by adding up the
+     *        values of all peer ranks.
+     *
+     * The same restrictions as for syncBegin() apply.
+     */
+    void syncAddBegin()
+    { startExchange_(); }
+
+    /*!
+     * \brief Finish the syncronization which was started by syncAddBegin().
+     */
+    void syncAddEnd()
+    {
+        // receive the entries from the peers
         for (const auto peerRank: overlap_->peerSet())
             receiveAdd_(peerRank);
 
@@ -291,6 +325,18 @@ private:
 #endif // HAVE_MPI
     }
 
+    void startExchange_()
+    {
+        // post the receives before sending anything, so that the incoming values can
+        // be written to their final destination directly
+        for (const auto peerRank: overlap_->peerSet())
+            valuesRecvBuff_[peerRank]->receiveAsync(peerRank);
+
+        // send all entries to all peers
+        for (const auto peerRank: overlap_->peerSet())
+            sendEntries_(peerRank);
+    }
+
     void sendEntries_(ProcessRank peerRank)
     {
         // copy the values into the send buffer
@@ -320,8 +366,8 @@ private:
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
         MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
-        // receive the values from the peer
-        values.receive(peerRank);
+        // wait until the values from the peer have arrived
+        values.wait();
 
         // copy them into the block vector
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -337,8 +383,8 @@ private:
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
         MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
-        // receive the values from the peer
-        values.receive(peerRank);
+        // wait until the values from the peer have arrived
+        values.wait();
 
         // add up the values of rows on the shared boundary
         for (unsigned j = 0; j < indices.size(); ++j) {
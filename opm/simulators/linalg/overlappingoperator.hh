@@ -30,26 +30,87 @@
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware linear operator usable by ISTL.
+ *
+ * If the communication is overlapped with the computation (cf.
+ * setOverlapCommunication()), the rows of the result which are seen by peer processes
+ * are computed first. Then their exchange is started and the remaining rows are
+ * computed while the values are in flight.
+ *
+ * The entries of the matrix-vector products are taken from the overlapping matrix
+ * unless a native matrix with the same layout is specified using setNativeMatrix().
  */
 template <class OverlappingMatrix, class DomainVector, class RangeVector>
 class OverlappingOperator
     : public Dune::AssembledLinearOperator<OverlappingMatrix, DomainVector, RangeVector>
 {
     typedef typename OverlappingMatrix::Overlap Overlap;
+    typedef typename OverlappingMatrix::NonOverlappingMatrix NonOverlappingMatrix;
 
 public:
     //! export types
     typedef DomainVector domain_type;
     typedef typename domain_type::field_type field_type;
 
-    OverlappingOperator(const OverlappingMatrix& A) : A_(A)
+    OverlappingOperator(const OverlappingMatrix& A)
+        : A_(A)
+        , M_(&A)
+        , overlapCommunication_(false)
+        , verifyOverlapCommunication_(false)
     {}
 
+    /*!
+     * \brief Specify whether the interior rows of the result ought to be computed
+     *        while the border rows are exchanged with the peer processes.
+     *
+     * This yields the same results as the conventional approach.
+     */
+    void setOverlapCommunication(bool value)
+    {
+        overlapCommunication_ = value;
+        if (overlapCommunication_ && sendRows_.empty() && interiorRows_.empty())
+            partitionRows_();
+    }
+
+    /*!
+     * \brief Returns true iff the interior rows of the result are computed while the
+     *        border rows are exchanged with the peer processes.
+     */
+    bool overlapCommunication() const
+    { return overlapCommunication_; }
+
+    /*!
+     * \brief Specify whether the results of the matrix-vector products which overlap
+     *        the communication with the computation are compared to the ones of the
+     *        conventional approach.
+     *
+     * If they differ, a std::logic_error is thrown. Since this doubles the cost of
+     * applying the operator, it is only intended for testing.
+     */
+    void setVerifyOverlapCommunication(bool value)
+    { verifyOverlapCommunication_ = value; }
+
+    /*!
+     * \brief Specify a native matrix which is used for the matrix-vector products
+     *        instead of the overlapping one.
+     *
+     * This requires the overlapping matrix to have the same layout as the native one
+     * (cf. OverlappingBCRSMatrix::hasNativeLayout()). Passing nullptr causes the
+     * overlapping matrix to be used again.
+     */
+    void setNativeMatrix(const NonOverlappingMatrix* nativeMatrix)
+    { M_ = nativeMatrix ? nativeMatrix : &A_; }
+
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2,6)
     //! the kind of computations supported by the operator. Either overlapping or non-overlapping
     Dune::SolverCategory::Category category() const override
@@ -62,19 +123,53 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
-        y.sync();
+        if (!overlapCommunication_ || sendRows_.empty()) {
+            M_->mv(x, y);
+            y.sync();
+            return;
+        }
+
+        mvRows_(x, y, sendRows_);
+        y.syncBegin();
+        mvRows_(x, y, interiorRows_);
+        y.syncEnd();
+
+        if (verifyOverlapCommunication_) {
+            RangeVector yRef(y);
+            M_->mv(x, yRef);
+            yRef.sync();
+            verifyResult_(y, yRef, "apply");
+        }
     }
 
     //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
-        y.sync();
+        if (!overlapCommunication_ || sendRows_.empty()) {
+            M_->usmv(alpha, x, y);
+            y.sync();
+            return;
+        }
+
+        std::unique_ptr<RangeVector> yRef;
+        if (verifyOverlapCommunication_)
+            yRef.reset(new RangeVector(y));
+
+        usmvRows_(alpha, x, y, sendRows_);
+        y.syncBegin();
+        usmvRows_(alpha, x, y, interiorRows_);
+        y.syncEnd();
+
+        if (verifyOverlapCommunication_) {
+            M_->usmv(alpha, x, *yRef);
+            yRef->sync();
+            verifyResult_(y, *yRef, "applyscaleadd");
+        }
     }
 
-    //! returns the matrix
+    //! returns the overlapping matrix. its entries are not up to date if a native matrix
+    //! has been specified via setNativeMatrix()
     virtual const OverlappingMatrix& getmat() const override
     { return A_; }
 
@@ -82,7 +177,82 @@ public:
     { return A_.overlap(); }
 
 private:
+    // split the rows into the ones which are sent to peer processes and the remaining
+    // ones
+    void partitionRows_()
+    {
+        const Overlap& overlap = A_.overlap();
+        std::vector<bool> isSendRow(A_.N(), false);
+        for (const auto peerRank: overlap.peerSet()) {
+            size_t n = overlap.foreignOverlapSize(peerRank);
+            for (unsigned i = 0; i < n; ++i)
+                isSendRow[static_cast<size_t>(overlap.foreignOverlapOffsetToDomesticIdx(peerRank, i))] = true;
+        }
+
+        sendRows_.clear();
+        interiorRows_.clear();
+        for (size_t rowIdx = 0; rowIdx < isSendRow.size(); ++rowIdx) {
+            if (isSendRow[rowIdx])
+                sendRows_.push_back(rowIdx);
+            else
+                interiorRows_.push_back(rowIdx);
+        }
+    }
+
+    // y_i = (A x)_i for all rows i in 'rows'
+    void mvRows_(const DomainVector& x, RangeVector& y, const std::vector<size_t>& rows) const
+    {
+        for (size_t rowIdx : rows) {
+            auto& yBlock = y[rowIdx];
+            yBlock = 0.0;
+
+            const auto& row = (*M_)[rowIdx];
+            const auto& colEndIt = row.end();
+            for (auto colIt = row.begin(); colIt != colEndIt; ++colIt)
+                colIt->umv(x[colIt.index()], yBlock);
+        }
+    }
+
+    // y_i += alpha*(A x)_i for all rows i in 'rows'
+    void usmvRows_(field_type alpha,
+                   const DomainVector& x,
+                   RangeVector& y,
+                   const std::vector<size_t>& rows) const
+    {
+        for (size_t rowIdx : rows) {
+            auto& yBlock = y[rowIdx];
+
+            const auto& row = (*M_)[rowIdx];
+            const auto& colEndIt = row.end();
+            for (auto colIt = row.begin(); colIt != colEndIt; ++colIt)
+                colIt->usmv(alpha, x[colIt.index()], yBlock);
+        }
+    }
+
+    // make sure that the result of the overlapped computation and communication is
+    // the same as the one of the conventional approach
+    void verifyResult_(const RangeVector& y, const RangeVector& yRef, const char* methodName) const
+    {
+        for (size_t rowIdx = 0; rowIdx < y.size(); ++rowIdx) {
+            auto diff = y[rowIdx];
+            diff -= yRef[rowIdx];
+            field_type tol = 1e-12*std::max<field_type>(yRef[rowIdx].infinity_norm(), 1.0);
+            if (diff.infinity_norm() > tol)
+                throw std::logic_error("The result of OverlappingOperator::"
+                                       + std::string(methodName)
+                                       + "() with overlapped communication differs "
+                                       "from the conventional one in row "
+                                       + std::to_string(rowIdx));
+        }
+    }
+
     const OverlappingMatrix& A_;
+    const NonOverlappingMatrix* M_;
+
+    bool overlapCommunication_;
+    bool verifyOverlapCommunication_;
+    std::vector<size_t> sendRows_;
+    std::vector<size_t> interiorRows_;
 };
 
 } // namespace Linear
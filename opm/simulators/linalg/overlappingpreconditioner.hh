@@ -40,6 +40,14 @@ namespace Linear {
 
 /*!
  * \brief An overlap aware preconditioner for any ISTL linear solver.
+ *
+ * By default, all processes agree on whether the sequential preconditioner has
+ * succeeded after each call to pre(), apply() and post(). This requires a global
+ * reduction per application of the preconditioner. If a scalar product is specified
+ * using setDeferredFailureAgreement(), failures of apply() are only recorded locally
+ * and the processes agree on them with the next global reduction of that scalar
+ * product. Since pre() and post() are only called once per linear solve, they always
+ * agree on failures immediately.
  */
 template <class SeqPreCond, class Overlap>
 class OverlappingPreconditioner
@@ -49,6 +57,7 @@ class OverlappingPreconditioner
 public:
     typedef typename SeqPreCond::domain_type domain_type;
     typedef typename SeqPreCond::range_type range_type;
+    typedef OverlappingScalarProduct<domain_type, Overlap> ScalarProduct;
 
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2,6)
     //! the kind of computations supported by the operator. Either overlapping or non-overlapping
@@ -60,9 +69,21 @@ public:
 #endif
 
     OverlappingPreconditioner(SeqPreCond& seqPreCond, const Overlap& overlap)
-        : seqPreCond_(seqPreCond), overlap_(&overlap)
+        : seqPreCond_(seqPreCond), overlap_(&overlap), failureScalarProduct_(nullptr)
     {}
 
+    /*!
+     * \brief Defer the agreement on failures of apply() to the next global reduction
+     *        of a scalar product.
+     *
+     * Every application of the preconditioner must be followed by a global reduction
+     * of the scalar product (or a call to its checkFailures() method) before its
+     * result is used for any decisions. Passing nullptr restores the default
+     * behavior.
+     */
+    void setDeferredFailureAgreement(const ScalarProduct* scalarProduct)
+    { failureScalarProduct_ = scalarProduct; }
+
     void pre(domain_type& x, range_type& y) override
     {
 #if HAVE_MPI
@@ -106,7 +127,20 @@ public:
     void apply(domain_type& x, const range_type& d) override
     {
 #if HAVE_MPI
-        if (overlap_->peerSet().size() > 0) {
+        if (overlap_->peerSet().size() > 0 && failureScalarProduct_) {
+            // only record failures locally. all processes must participate in the
+            // synchronization of the result regardless.
+            try {
+                seqPreCond_.apply(x, d);
+            }
+            catch (...) {
+                x = 0.0;
+                failureScalarProduct_->reportLocalFailure();
+            }
+
+            x.sync();
+        }
+        else if (overlap_->peerSet().size() > 0) {
             // make sure that all processes react the same if the
             // sequential preconditioner on one process throws an
             // exception
@@ -185,6 +219,7 @@ public:
 private:
     SeqPreCond& seqPreCond_;
     const Overlap *overlap_;
+    const ScalarProduct* failureScalarProduct_;
 };
 
 } // namespace Linear
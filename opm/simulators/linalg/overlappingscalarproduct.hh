@@ -27,15 +27,30 @@
 #ifndef EWOMS_OVERLAPPING_SCALAR_PRODUCT_HH
 #define EWOMS_OVERLAPPING_SCALAR_PRODUCT_HH
 
+#include "krylovkernels.hh"
+
+#include <opm/material/common/Exceptions.hpp>
+
 #include <dune/common/version.hh>
 #include <dune/common/parallel/mpihelper.hh>
 #include <dune/istl/scalarproducts.hh>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware ISTL scalar product.
+ *
+ * Besides computing scalar products, objects of this class can be used to agree on
+ * failures of operations which only involve the current process without requiring an
+ * additional global reduction: Failures are recorded using reportLocalFailure() and
+ * the failure flags of all processes are added up by the next global reduction of
+ * the scalar product. If any process has failed, that reduction throws an
+ * Opm::NumericalIssue exception on all processes.
  */
 template <class OverlappingBlockVector, class Overlap>
 class OverlappingScalarProduct
@@ -62,6 +77,7 @@ public:
 
     OverlappingScalarProduct(const Overlap& overlap)
         : overlap_(overlap), comm_( Dune::MPIHelper::getCollectiveCommunication() )
+        , localFailure_(0)
     {}
 
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
@@ -72,15 +88,12 @@ public:
                    const OverlappingBlockVector& y) override
 #endif
     {
-        field_type sum = 0;
-        size_t numLocal = overlap_.numLocal();
-        for (unsigned localIdx = 0; localIdx < numLocal; ++localIdx) {
-            if (overlap_.iAmMasterOf(static_cast<int>(localIdx)))
-                sum += x[localIdx] * y[localIdx];
-        }
+        std::array<field_type, 1> sum;
+        dots(sum,
+             std::array<const OverlappingBlockVector*, 1>{{&x}},
+             std::array<const OverlappingBlockVector*, 1>{{&y}});
 
-        // return the global sum
-        return comm_.sum( sum );
+        return sum[0];
     }
 
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
@@ -90,9 +103,61 @@ public:
 #endif
     { return std::sqrt(dot(x, x)); }
 
+    /*!
+     * \brief Compute several scalar products using a single global reduction.
+     *
+     * On return, the i-th entry of 'result' is the scalar product of the vectors
+     * pointed to by x[i] and y[i].
+     */
+    template <size_t numDots>
+    void dots(std::array<field_type, numDots>& result,
+              const std::array<const OverlappingBlockVector*, numDots>& x,
+              const std::array<const OverlappingBlockVector*, numDots>& y) const
+    {
+        KrylovKernels::dots(result, x, y, overlap_.masterIndices());
+
+        // compute all global sums at once. the failure flags of the processes are
+        // added up by the same reduction.
+        std::array<field_type, numDots + 1> buffer;
+        std::copy(result.begin(), result.end(), buffer.begin());
+        buffer[numDots] = static_cast<field_type>(localFailure_);
+        comm_.sum(buffer.data(), static_cast<int>(numDots + 1));
+        throwIfFailed_(buffer[numDots]);
+
+        std::copy(buffer.begin(), buffer.begin() + numDots, result.begin());
+    }
+
+    /*!
+     * \brief Record that an operation of the current linear solve has failed on the
+     *        current process.
+     *
+     * The next global reduction of the scalar product will throw an exception on all
+     * processes.
+     */
+    void reportLocalFailure() const
+    { localFailure_ = 1; }
+
+    /*!
+     * \brief Throw an Opm::NumericalIssue exception on all processes if any process
+     *        has reported a failure since the last global reduction.
+     *
+     * This method is collective, i.e., it must be called by all processes.
+     */
+    void checkFailures() const
+    { throwIfFailed_(comm_.sum(static_cast<field_type>(localFailure_))); }
+
 private:
+    void throwIfFailed_(field_type numFailures) const
+    {
+        if (numFailures > 0) {
+            localFailure_ = 0;
+            throw Opm::NumericalIssue("An operation of the linear solver failed on some process");
+        }
+    }
+
     const Overlap& overlap_;
     const CollectiveCommunication comm_;
+    mutable int localFailure_;
 };
 
 } // namespace Linear
@@ -52,14 +52,30 @@ BEGIN_PROPERTIES
 NEW_TYPE_TAG(ParallelAmgLinearSolver, INHERITS_FROM(ParallelBaseLinearSolver));
 
 NEW_PROP_TAG(AmgCoarsenTarget);
+
+/*!
+ * \brief Specifies whether the aggregates of the AMG are kept when its hierarchy is
+ *        updated.
+ *
+ * In this case, only the Galerkin products, the smoothers and the coarse solver are
+ * recomputed for the new matrix.
+ */
+NEW_PROP_TAG(AmgReuseHierarchy);
 NEW_PROP_TAG(LinearSolverMaxError);
+NEW_PROP_TAG(LinearSolverFuseReductions);
 
 //! The target number of DOFs per processor for the parallel algebraic
 //! multi-grid solver
 SET_INT_PROP(ParallelAmgLinearSolver, AmgCoarsenTarget, 5000);
 
+//! recompute the complete AMG hierarchy by default
+SET_BOOL_PROP(ParallelAmgLinearSolver, AmgReuseHierarchy, false);
+
 SET_SCALAR_PROP(ParallelAmgLinearSolver, LinearSolverMaxError, 1e7);
 
+//! compute the scalar products of the BiCGStab solver one after another by default
+SET_BOOL_PROP(ParallelAmgLinearSolver, LinearSolverFuseReductions, false);
+
 SET_TYPE_PROP(ParallelAmgLinearSolver, LinearSolverBackend,
               Opm::Linear::ParallelAmgBackend<TypeTag>);
 
@@ -135,7 +151,10 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
 
     typedef BiCGStabSolver<ParallelOperator,
                            OverlappingVector,
-                           AMG> RawLinearSolver;
+                           AMG,
+                           ParallelScalarProduct> RawLinearSolver;
+    typedef CombinedCriterion<OverlappingVector,
+                              typename GridView::CollectiveCommunication> LinearSolverCriterion;
 
     static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The ParallelAmgBackend linear solver backend requires the IstlSparseMatrixAdapter");
@@ -152,16 +171,61 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, LinearSolverMaxError,
                              "The maximum residual error which the linear solver tolerates"
                              " without giving up");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverFuseReductions,
+                             "Compute the scalar products of each iteration of the linear "
+                             "solver using as few global reductions as possible");
         EWOMS_REGISTER_PARAM(TypeTag, int, AmgCoarsenTarget,
                              "The coarsening target for the agglomerations of "
                              "the AMG preconditioner");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, AmgReuseHierarchy,
+                             "Keep the aggregates of the AMG preconditioner and only "
+                             "recompute its Galerkin products and smoothers if it is "
+                             "updated");
     }
 
 protected:
     friend ParentType;
 
+    void cleanup_()
+    {
+        // the temporary vectors of the solver refer to the overlap which is about to
+        // be deleted. the same applies to the solver itself because it refers to the
+        // parallel scalar product.
+        workspace_.clear();
+        bicgstabSolver_.reset();
+        convCrit_.reset();
+
+        // the same applies to the AMG hierarchy and the operators it is based on
+        amg_.reset();
+        fineOperator_.reset();
+#if HAVE_MPI
+        istlComm_.reset();
+#endif
+
+        ParentType::cleanup_();
+    }
+
     std::shared_ptr<AMG> preparePreconditioner_()
     {
+        if (this->reusePreconditioner_ && amg_)
+            return amg_;
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,6)
+        // the fine operator refers to the overlapping matrix, whose sparsity pattern
+        // stays the same until the AMG is discarded by cleanup_(). the aggregates thus
+        // remain valid and only the matrices of the coarse levels need to be recomputed.
+        if (amg_ && EWOMS_GET_PARAM(TypeTag, bool, AmgReuseHierarchy)) {
+            try {
+                amg_->recalculateHierarchy();
+            }
+            catch (...) {
+                amg_.reset();
+                throw;
+            }
+            return amg_;
+        }
+#endif
+
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
@@ -182,38 +246,73 @@ protected:
         return amg_;
     }
 
+    // the AMG hierarchy is built from the overlapping matrix, so its entries are
+    // always required
+    bool nativeMatrixUsable_() const
+    { return false; }
+
+    // besides being reused as is, the AMG hierarchy may be kept for recalculating the
+    // matrices of its coarse levels
+    bool preconditionerReuseEnabled_() const
+    {
+        return ParentType::preconditionerReuseEnabled_()
+            || EWOMS_GET_PARAM(TypeTag, bool, AmgReuseHierarchy);
+    }
+
     void cleanupPreconditioner_()
-    { /* nothing to do */ }
+    {
+        // keep the AMG only if it may be used by the next linear solve
+        if (this->lastSolveConverged_ && preconditionerReuseEnabled_())
+            return;
+
+        amg_.reset();
+        fineOperator_.reset();
+#if HAVE_MPI
+        istlComm_.reset();
+#endif
+        this->preconditionerAge_ = -1;
+    }
 
     std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
                                                     ParallelScalarProduct& parScalarProduct,
                                                     AMG& parPreCond)
     {
-        const auto& gridView = this->simulator_.gridView();
-        typedef CombinedCriterion<OverlappingVector, decltype(gridView.comm())> CCC;
-
         Scalar linearSolverTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
         Scalar linearSolverAbsTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverAbsTolerance);
         if(linearSolverAbsTolerance < 0.0)
             linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance()/100.0;
 
-        convCrit_.reset(new CCC(gridView.comm(),
-                                /*residualReductionTolerance=*/linearSolverTolerance,
-                                /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
-                                EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverMaxError)));
-
-        auto bicgstabSolver =
-            std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct);
+        // the solver and its convergence criterion are kept until the structure of the
+        // linear system changes. only the objects which may change between two linear
+        // solves are updated.
+        if (!bicgstabSolver_) {
+            convCrit_.reset(new LinearSolverCriterion(this->simulator_.gridView().comm(),
+                                                      /*residualReductionTolerance=*/linearSolverTolerance,
+                                                      /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
+                                                      EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverMaxError)));
+
+            bicgstabSolver_ =
+                std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct);
+
+            int verbosity = 0;
+            if (parOperator.overlap().myRank() == 0)
+                verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+            bicgstabSolver_->setVerbosity(verbosity);
+            bicgstabSolver_->setMaxIterations(EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations));
+            bicgstabSolver_->setFuseReductions(EWOMS_GET_PARAM(TypeTag, bool, LinearSolverFuseReductions));
+            bicgstabSolver_->setWorkspace(&workspace_);
+        }
+        else {
+            // the absolute tolerance may depend on the tolerance of the Newton method
+            convCrit_->setResidualReductionTolerance(linearSolverTolerance);
+            convCrit_->setAbsResidualTolerance(linearSolverAbsTolerance);
+            bicgstabSolver_->setPreconditioner(parPreCond);
+        }
 
-        int verbosity = 0;
-        if (parOperator.overlap().myRank() == 0)
-            verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
-        bicgstabSolver->setVerbosity(verbosity);
-        bicgstabSolver->setMaxIterations(EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations));
-        bicgstabSolver->setLinearOperator(&parOperator);
-        bicgstabSolver->setRhs(this->overlappingb_);
+        bicgstabSolver_->setLinearOperator(&parOperator);
+        bicgstabSolver_->setRhs(this->overlappingb_);
 
-        return bicgstabSolver;
+        return bicgstabSolver_;
     }
 
     std::pair<bool,int> runSolver_(std::shared_ptr<RawLinearSolver> solver)
@@ -300,7 +399,9 @@ protected:
 #endif
     }
 
-    std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
+    std::shared_ptr<RawLinearSolver> bicgstabSolver_;
+    std::unique_ptr<LinearSolverCriterion> convCrit_;
+    typename RawLinearSolver::Workspace workspace_;
 
     std::shared_ptr<FineOperator> fineOperator_;
     std::shared_ptr<AMG> amg_;
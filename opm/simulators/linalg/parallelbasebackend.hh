@@ -35,12 +35,16 @@
 #include <opm/simulators/linalg/overlappingoperator.hh>
 #include <opm/simulators/linalg/parallelbasebackend.hh>
 #include <opm/simulators/linalg/istlpreconditionerwrappers.hh>
+#include <opm/simulators/linalg/linearsolverreport.hh>
 
 #include <opm/models/utils/genericguard.hh>
+#include <opm/models/utils/timer.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
 
+#include <opm/material/common/Unused.hpp>
+
 #include <dune/grid/io/file/vtk/vtkwriter.hh>
 
 #include <dune/common/fvector.hh>
@@ -48,7 +52,9 @@
 
 #include <sstream>
 #include <memory>
+#include <stdexcept>
 #include <iostream>
+#include <type_traits>
 
 BEGIN_PROPERTIES
 NEW_TYPE_TAG(ParallelBaseLinearSolver);
@@ -79,6 +85,16 @@ NEW_PROP_TAG(PreconditionerWrapper);
 //! The floating point type used internally by the linear solver
 NEW_PROP_TAG(LinearSolverScalar);
 
+/*!
+ * \brief The floating point type used to store the preconditioner.
+ *
+ * Preconditioners which support this store their data using this type while the
+ * iterations of the Krylov solver use LinearSolverScalar. Using single precision halves
+ * the memory bandwidth required to apply the preconditioner, but may increase the number
+ * of iterations of the linear solver.
+ */
+NEW_PROP_TAG(PreconditionerScalar);
+
 /*!
  * \brief The size of the algebraic overlap of the linear solver.
  *
@@ -110,12 +126,57 @@ NEW_PROP_TAG(LinearSolverVerbosity);
 //! Maximum number of iterations eyecuted by the linear solver
 NEW_PROP_TAG(LinearSolverMaxIterations);
 
+/*!
+ * \brief Specifies whether the interior rows of matrix-vector products are computed
+ *        while the border rows are exchanged with the peer processes.
+ */
+NEW_PROP_TAG(LinearSolverOverlapCommunication);
+
+/*!
+ * \brief Specifies whether the results of the matrix-vector products which overlap the
+ *        communication with the computation are compared to the ones of the
+ *        conventional approach.
+ *
+ * This is only intended for testing because it doubles the cost of the matrix-vector
+ * products.
+ */
+NEW_PROP_TAG(LinearSolverVerifyOverlapCommunication);
+
 //! The order of the sequential preconditioner
 NEW_PROP_TAG(PreconditionerOrder);
 
 //! The relaxation factor of the preconditioner
 NEW_PROP_TAG(PreconditionerRelaxation);
 
+/*!
+ * \brief Specifies whether the processes agree on failures of the preconditioner using
+ *        the next global reduction of the linear solver.
+ *
+ * Otherwise, each application of the preconditioner requires a global reduction.
+ */
+NEW_PROP_TAG(PreconditionerDeferFailures);
+
+/*!
+ * \brief The maximum number of consecutive linear solves which use the preconditioner of
+ *        an earlier linear solve without updating it.
+ *
+ * The sparsity pattern of the linear system does not change between Newton iterations
+ * and often, the matrix only changes slightly. 0 means that the preconditioner is
+ * updated for every linear solve.
+ */
+NEW_PROP_TAG(PreconditionerMaxReuse);
+
+/*!
+ * \brief The preconditioner is only reused if the previous linear solve needed at most
+ *        this number of iterations.
+ *
+ * A negative value means that the number of iterations is not considered.
+ */
+NEW_PROP_TAG(PreconditionerReuseMaxIterations);
+
+// the Newton method may solve several linear systems for the same matrix
+NEW_PROP_TAG(NewtonEnableJacobianReuse);
+
 //! Set the type of a global jacobian matrix for linear solvers that are based on
 //! dune-istl.
 SET_PROP(ParallelBaseLinearSolver, SparseMatrixAdapter)
@@ -158,6 +219,8 @@ namespace Linear {
  *            that it is computationally cheaper because it does not
  *            need to consider things which are only required for
  *            higher orders
+ * - \c BlockILU0: A native block ILU(0) preconditioner which stores its factorization
+ *                 in a contiguous layout and which can use multiple threads
  */
 template <class TypeTag>
 class ParallelBaseBackend
@@ -168,6 +231,7 @@ protected:
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, LinearSolverScalar) LinearSolverScalar;
+    typedef typename GET_PROP_TYPE(TypeTag, PreconditionerScalar) PreconditionerScalar;
     typedef typename GET_PROP_TYPE(TypeTag, SparseMatrixAdapter) SparseMatrixAdapter;
     typedef typename GET_PROP_TYPE(TypeTag, GlobalEqVector) Vector;
     typedef typename GET_PROP_TYPE(TypeTag, BorderListCreator) BorderListCreator;
@@ -176,6 +240,8 @@ protected:
     typedef typename GET_PROP_TYPE(TypeTag, Overlap) Overlap;
     typedef typename GET_PROP_TYPE(TypeTag, OverlappingVector) OverlappingVector;
     typedef typename GET_PROP_TYPE(TypeTag, OverlappingMatrix) OverlappingMatrix;
+    typedef typename OverlappingMatrix::NonOverlappingMatrix NonOverlappingMatrix;
+    typedef typename SparseMatrixAdapter::IstlMatrix IstlMatrix;
 
     typedef typename GET_PROP_TYPE(TypeTag, PreconditionerWrapper) PreconditionerWrapper;
     typedef typename PreconditionerWrapper::SequentialPreconditioner SequentialPreconditioner;
@@ -193,10 +259,18 @@ public:
         : simulator_(simulator)
         , gridSequenceNumber_( -1 )
         , lastIterations_( -1 )
+        , lastSolveConverged_( false )
+        , preconditionerAge_( -1 )
+        , reusePreconditioner_( false )
+        , matrixChanged_( true )
+        , useNativeMatrix_( false )
     {
         overlappingMatrix_ = nullptr;
+        nativeMatrix_ = nullptr;
         overlappingb_ = nullptr;
         overlappingx_ = nullptr;
+        parScalarProduct_ = nullptr;
+        parOperator_ = nullptr;
     }
 
     ~ParallelBaseBackend()
@@ -217,6 +291,24 @@ public:
                              "The maximum number of iterations of the linear solver");
         EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverVerbosity,
                              "The verbosity level of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, PreconditionerDeferFailures,
+                             "Agree on failures of the preconditioner using the next "
+                             "global reduction of the linear solver instead of after "
+                             "each application of the preconditioner");
+        EWOMS_REGISTER_PARAM(TypeTag, int, PreconditionerMaxReuse,
+                             "The maximum number of consecutive linear solves which use "
+                             "the preconditioner of an earlier linear solve without "
+                             "updating it");
+        EWOMS_REGISTER_PARAM(TypeTag, int, PreconditionerReuseMaxIterations,
+                             "The maximum number of iterations of a linear solve for its "
+                             "preconditioner to be reused by the next one (-1: no limit)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverOverlapCommunication,
+                             "Compute the interior rows of matrix-vector products while "
+                             "the border rows are exchanged with the peer processes");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverVerifyOverlapCommunication,
+                             "Compare the results of the matrix-vector products which "
+                             "overlap the communication with the computation to the ones "
+                             "of the conventional approach (for testing only)");
 
         PreconditionerWrapper::registerParameters();
     }
@@ -249,18 +341,30 @@ public:
         BorderListCreator borderListCreator(simulator_.gridView(),
                                             simulator_.model().dofMapper());
 
-        // create the overlapping Jacobian matrix
+        // create the overlapping Jacobian matrix. if it would be identical to the native
+        // one, the linear solver works on the native matrix directly, so the entries of
+        // the overlapping matrix are not allocated.
         unsigned overlapSize = EWOMS_GET_PARAM(TypeTag, unsigned, LinearSolverOverlapSize);
+        bool nativeMatrixUsable = asImp_().nativeMatrixUsable_();
         overlappingMatrix_ = new OverlappingMatrix(M.istlMatrix(),
                                                    borderListCreator.borderList(),
                                                    borderListCreator.blackList(),
-                                                   overlapSize);
+                                                   overlapSize,
+                                                   /*allocateIfNativeLayout=*/!nativeMatrixUsable);
+        useNativeMatrix_ = nativeMatrixUsable && overlappingMatrix_->hasNativeLayout();
 
         // create the overlapping vectors for the residual and the
         // solution
         overlappingb_ = new OverlappingVector(overlappingMatrix_->overlap());
         overlappingx_ = new OverlappingVector(*overlappingb_);
 
+        // the parallel scalar product and the parallel operator only depend on the
+        // structure of the linear system, so they can be kept until it changes
+        parScalarProduct_ = new ParallelScalarProduct(overlappingMatrix_->overlap());
+        parOperator_ = new ParallelOperator(*overlappingMatrix_);
+        parOperator_->setOverlapCommunication(EWOMS_GET_PARAM(TypeTag, bool, LinearSolverOverlapCommunication));
+        parOperator_->setVerifyOverlapCommunication(EWOMS_GET_PARAM(TypeTag, bool, LinearSolverVerifyOverlapCommunication));
+
         // writeOverlapToVTK_();
     }
 
@@ -292,16 +396,38 @@ public:
      *
      * This method also synchronizes the data structure across the processes which are
      * involved in the simulation run.
+     *
+     * If the process does not have any peers and the linear solver uses the same
+     * floating point type as the linearization, the entries are not copied: the linear
+     * solver then works on the matrix passed here, which thus must not be modified or
+     * destroyed until the next call to setMatrix() or eraseMatrix().
      */
     void setMatrix(const SparseMatrixAdapter& M)
     {
-        overlappingMatrix_->assignFromNative(M.istlMatrix());
-        overlappingMatrix_->syncAdd();
+        if (useNativeMatrix_) {
+            const NonOverlappingMatrix* nativeMatrix = nativeMatrixPtr_(M.istlMatrix());
+
+            // the preconditioner may refer to the previous native matrix
+            if (nativeMatrix != nativeMatrix_)
+                releasePreconditioner_();
+
+            nativeMatrix_ = nativeMatrix;
+            parOperator_->setNativeMatrix(nativeMatrix_);
+        }
+        else {
+            overlappingMatrix_->assignFromNative(M.istlMatrix());
+            overlappingMatrix_->syncAdd();
+        }
+        matrixChanged_ = true;
     }
 
     /*!
      * \brief Actually solve the linear system of equations.
      *
+     * If setMatrix() has not been called since the last successful linear solve, the
+     * matrix is the same as for the last solve. If its preconditioner has been kept
+     * (cf. preconditionerReuseEnabled_()), it is then used as is.
+     *
      * \return true if the residual reduction could be achieved, else false.
      */
     bool solve(Vector& x)
@@ -311,19 +437,39 @@ public:
         Dune::FMatrixPrecision<LinearSolverScalar>::set_absolute_limit(1.e-30);
 #endif
 
+        if (useNativeMatrix_ && !nativeMatrix_)
+            throw std::logic_error("The matrix must be specified using setMatrix() before "
+                                   "the linear system can be solved");
+
         (*overlappingx_) = 0.0;
 
+        // decide whether the preconditioner of an earlier linear solve is good enough.
+        // if the linear solve does not finish successfully, the preconditioner is
+        // recomputed the next time.
+        report_.reset();
+        bool matrixUnchanged = !matrixChanged_ && preconditionerAge_ >= 0 && lastSolveConverged_;
+        reusePreconditioner_ = matrixUnchanged || preconditionerReusable_();
+        report_.setPreconditionerReused(reusePreconditioner_);
+        lastSolveConverged_ = false;
+        matrixChanged_ = false;
+
+        report_.setupTimer().start();
         auto parPreCond = asImp_().preparePreconditioner_();
+        report_.setupTimer().stop();
+
+        // reusing the preconditioner for the same matrix does not make it any worse
+        if (!reusePreconditioner_)
+            preconditionerAge_ = 0;
+        else if (!matrixUnchanged)
+            ++preconditionerAge_;
+
         auto precondCleanupFn = [this]() -> void
                                 { this->asImp_().cleanupPreconditioner_(); };
         auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
-        // create the parallel scalar product and the parallel operator
-        ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
-        ParallelOperator parOperator(*overlappingMatrix_);
 
         // retrieve the linear solver
-        auto solver = asImp_().prepareSolver_(parOperator,
-                                              parScalarProduct,
+        auto solver = asImp_().prepareSolver_(*parOperator_,
+                                              *parScalarProduct_,
                                               *parPreCond);
 
         auto cleanupSolverFn =
@@ -332,9 +478,36 @@ public:
         GenericGuard<decltype(cleanupSolverFn)> solverGuard(cleanupSolverFn);
 
         // run the linear solver and have some fun
+        report_.timer().start();
         auto result = asImp_().runSolver_(solver);
+
+        // make sure that failures of the preconditioner which happened after the last
+        // global reduction of the solver are not missed
+        if (EWOMS_GET_PARAM(TypeTag, bool, PreconditionerDeferFailures))
+            parScalarProduct_->checkFailures();
+        report_.timer().stop();
+
         // store number of iterations used
         lastIterations_ = result.second;
+        lastSolveConverged_ = result.first;
+        report_.setIterations(static_cast<unsigned>(result.second));
+        report_.setConverged(result.first);
+
+        // the number of iterations and the times required by a linear solve allow to
+        // assess the tradeoffs of reusing the preconditioner and of using a lower
+        // precision for it
+        if (EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity) > 0
+            && overlappingMatrix_->overlap().myRank() == 0)
+        {
+            std::cout << "Linear solve: " << lastIterations_ << " iterations, "
+                      << report_.setupTimer().realTimeElapsed() << " seconds for "
+                      << (reusePreconditioner_ ? "reusing" : "setting up")
+                      << " the preconditioner, "
+                      << report_.timer().realTimeElapsed() << " seconds for the iterations ("
+                      << 8*sizeof(LinearSolverScalar) << " bit Krylov iterations, "
+                      << 8*sizeof(PreconditionerScalar) << " bit preconditioner)\n"
+                      << std::flush;
+        }
 
         // copy the result back to the non-overlapping vector
         overlappingx_->assignTo(x);
@@ -349,6 +522,15 @@ public:
     size_t iterations () const
     { return lastIterations_; }
 
+    /*!
+     * \brief Return the report of the last linear solve.
+     *
+     * The time required to set up the preconditioner is reported separately from the
+     * time spent on the iterations of the linear solver.
+     */
+    const Opm::Linear::SolverReport& report() const
+    { return report_; }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -358,22 +540,110 @@ protected:
 
     void cleanup_()
     {
+        // the preconditioner refers to the matrix which is about to be deleted
+        releasePreconditioner_();
+
         // create the overlapping Jacobian matrix and vectors
         delete overlappingMatrix_;
         delete overlappingb_;
         delete overlappingx_;
+        delete parScalarProduct_;
+        delete parOperator_;
 
+        nativeMatrix_ = nullptr;
+        useNativeMatrix_ = false;
         overlappingMatrix_ = 0;
         overlappingb_ = 0;
         overlappingx_ = 0;
+        parScalarProduct_ = 0;
+        parOperator_ = 0;
+    }
+
+    /*!
+     * \brief Returns true if the preconditioner of the previous linear solve can be
+     *        used for the next one without updating it.
+     *
+     * This is the case if the previous linear solve converged, if it did not need more
+     * iterations than specified by the PreconditionerReuseMaxIterations parameter and
+     * if the preconditioner has not been reused for more than PreconditionerMaxReuse
+     * consecutive linear solves. The decision only depends on quantities which are the
+     * same on all processes.
+     */
+    bool preconditionerReusable_() const
+    {
+        if (preconditionerAge_ < 0 || !lastSolveConverged_)
+            return false;
+
+        int maxReuse = EWOMS_GET_PARAM(TypeTag, int, PreconditionerMaxReuse);
+        if (preconditionerAge_ >= maxReuse)
+            return false;
+
+        int maxIterations = EWOMS_GET_PARAM(TypeTag, int, PreconditionerReuseMaxIterations);
+        return maxIterations < 0 || lastIterations_ <= static_cast<size_t>(maxIterations);
+    }
+
+    /*!
+     * \brief Returns true if the linear solver may work on the native matrix if the
+     *        overlapping one would be identical to it.
+     *
+     * This requires the native matrix to be of the same type as the matrix which stores
+     * the entries of the overlapping one, i.e., the linear solver must use the same
+     * floating point type as the linearization.
+     */
+    bool nativeMatrixUsable_() const
+    { return std::is_same<IstlMatrix, NonOverlappingMatrix>::value; }
+
+    // the matrix on which the linear solver works
+    const NonOverlappingMatrix& systemMatrix_() const
+    {
+        if (useNativeMatrix_)
+            return *nativeMatrix_;
+        return *overlappingMatrix_;
+    }
+
+    static const NonOverlappingMatrix* nativeMatrixPtr_(const NonOverlappingMatrix& M)
+    { return &M; }
+
+    // the native matrix cannot be used if it is of a different type
+    template <class NativeMatrix>
+    static const NonOverlappingMatrix* nativeMatrixPtr_(const NativeMatrix& M OPM_UNUSED)
+    { return nullptr; }
+
+    /*!
+     * \brief Returns true if the preconditioner of a successful linear solve may be
+     *        used by the next one.
+     *
+     * This is the case if the preconditioner may be reused for a modified matrix (cf.
+     * the PreconditionerMaxReuse parameter) or if the Newton method may reuse the
+     * Jacobian matrix. Otherwise, the preconditioner is released after each linear
+     * solve to keep the memory requirements low.
+     */
+    bool preconditionerReuseEnabled_() const
+    {
+        return EWOMS_GET_PARAM(TypeTag, int, PreconditionerMaxReuse) > 0
+            || EWOMS_GET_PARAM(TypeTag, bool, NewtonEnableJacobianReuse);
+    }
+
+    void releasePreconditioner_()
+    {
+        if (parPreCond_) {
+            parPreCond_.reset();
+            precWrapper_.cleanup();
+        }
+        preconditionerAge_ = -1;
     }
 
     std::shared_ptr<ParallelPreconditioner> preparePreconditioner_()
     {
+        if (reusePreconditioner_)
+            return parPreCond_;
+
+        releasePreconditioner_();
+
         int preconditionerIsReady = 1;
         try {
             // update sequential preconditioner
-            precWrapper_.prepare(*overlappingMatrix_);
+            precWrapper_.prepare(systemMatrix_());
         }
         catch (const Dune::Exception& e) {
             std::cout << "Preconditioner threw exception \"" << e.what()
@@ -389,12 +659,20 @@ protected:
             throw Opm::NumericalIssue("Creating the preconditioner failed");
 
         // create the parallel preconditioner
-        return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+        parPreCond_ =
+            std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+        if (EWOMS_GET_PARAM(TypeTag, bool, PreconditionerDeferFailures))
+            parPreCond_->setDeferredFailureAgreement(parScalarProduct_);
+
+        return parPreCond_;
     }
 
     void cleanupPreconditioner_()
     {
-        precWrapper_.cleanup();
+        // keep the preconditioner only if it may be reused by the next linear solve,
+        // i.e., if the linear solve was successful and reusing it is enabled
+        if (!lastSolveConverged_ || !asImp_().preconditionerReuseEnabled_())
+            releasePreconditioner_();
     }
 
     void writeOverlapToVTK_()
@@ -437,12 +715,28 @@ protected:
     const Simulator& simulator_;
     int gridSequenceNumber_;
     size_t lastIterations_;
+    bool lastSolveConverged_;
+
+    // the number of linear solves which have reused the current preconditioner or -1
+    // if there is none
+    int preconditionerAge_;
+    bool reusePreconditioner_;
+    bool matrixChanged_;
+    Opm::Linear::SolverReport report_;
+
+    // the linear solver works on the native matrix instead of the overlapping one if
+    // the latter would be identical to it
+    bool useNativeMatrix_;
+    const NonOverlappingMatrix* nativeMatrix_;
 
     OverlappingMatrix *overlappingMatrix_;
     OverlappingVector *overlappingb_;
     OverlappingVector *overlappingx_;
+    ParallelScalarProduct *parScalarProduct_;
+    ParallelOperator *parOperator_;
 
     PreconditionerWrapper precWrapper_;
+    std::shared_ptr<ParallelPreconditioner> parPreCond_;
 };
 }} // namespace Linear, Ewoms
 
@@ -451,18 +745,38 @@ BEGIN_PROPERTIES
 //! make the linear solver shut up by default
 SET_INT_PROP(ParallelBaseLinearSolver, LinearSolverVerbosity, 0);
 
+//! exchange the border rows of matrix-vector products after computing all rows by
+//! default
+SET_BOOL_PROP(ParallelBaseLinearSolver, LinearSolverOverlapCommunication, false);
+SET_BOOL_PROP(ParallelBaseLinearSolver, LinearSolverVerifyOverlapCommunication, false);
+
 //! set the preconditioner relaxation parameter to 1.0 by default
 SET_SCALAR_PROP(ParallelBaseLinearSolver, PreconditionerRelaxation, 1.0);
 
 //! set the preconditioner order to 0 by default
 SET_INT_PROP(ParallelBaseLinearSolver, PreconditionerOrder, 0);
 
+//! agree on failures of the preconditioner after each of its applications by default
+SET_BOOL_PROP(ParallelBaseLinearSolver, PreconditionerDeferFailures, false);
+
+//! update the preconditioner for each linear solve by default
+SET_INT_PROP(ParallelBaseLinearSolver, PreconditionerMaxReuse, 0);
+
+//! do not limit the number of iterations of a linear solve whose preconditioner is
+//! reused by default
+SET_INT_PROP(ParallelBaseLinearSolver, PreconditionerReuseMaxIterations, -1);
+
 //! by default use the same kind of floating point values for the linearization and for
 //! the linear solve
 SET_TYPE_PROP(ParallelBaseLinearSolver,
               LinearSolverScalar,
               typename GET_PROP_TYPE(TypeTag, Scalar));
 
+//! by default, the preconditioner uses the same floating point type as the linear solver
+SET_TYPE_PROP(ParallelBaseLinearSolver,
+              PreconditionerScalar,
+              typename GET_PROP_TYPE(TypeTag, LinearSolverScalar));
+
 SET_PROP(ParallelBaseLinearSolver, OverlappingMatrix)
 {
 private:
@@ -45,6 +45,7 @@ BEGIN_PROPERTIES
 NEW_TYPE_TAG(ParallelBiCGStabLinearSolver, INHERITS_FROM(ParallelBaseLinearSolver));
 
 NEW_PROP_TAG(LinearSolverMaxError);
+NEW_PROP_TAG(LinearSolverFuseReductions);
 
 SET_TYPE_PROP(ParallelBiCGStabLinearSolver,
               LinearSolverBackend,
@@ -52,6 +53,9 @@ SET_TYPE_PROP(ParallelBiCGStabLinearSolver,
 
 SET_SCALAR_PROP(ParallelBiCGStabLinearSolver, LinearSolverMaxError, 1e7);
 
+//! compute the scalar products of the BiCGStab solver one after another by default
+SET_BOOL_PROP(ParallelBiCGStabLinearSolver, LinearSolverFuseReductions, false);
+
 END_PROPERTIES
 
 namespace Opm {
@@ -89,6 +93,7 @@ class ParallelBiCGStabSolverBackend : public ParallelBaseBackend<TypeTag>
 
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
     typedef typename GET_PROP_TYPE(TypeTag, SparseMatrixAdapter) SparseMatrixAdapter;
 
     typedef typename ParentType::ParallelOperator ParallelOperator;
@@ -100,7 +105,10 @@ class ParallelBiCGStabSolverBackend : public ParallelBaseBackend<TypeTag>
 
     typedef BiCGStabSolver<ParallelOperator,
                            OverlappingVector,
-                           ParallelPreconditioner> RawLinearSolver;
+                           ParallelPreconditioner,
+                           ParallelScalarProduct> RawLinearSolver;
+    typedef CombinedCriterion<OverlappingVector,
+                              typename GridView::CollectiveCommunication> LinearSolverCriterion;
 
     static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The ParallelIstlSolverBackend linear solver backend requires the IstlSparseMatrixAdapter");
@@ -117,40 +125,66 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, LinearSolverMaxError,
                              "The maximum residual error which the linear solver tolerates"
                              " without giving up");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverFuseReductions,
+                             "Compute the scalar products of each iteration of the linear "
+                             "solver using as few global reductions as possible");
     }
 
 protected:
     friend ParentType;
 
+    void cleanup_()
+    {
+        // the temporary vectors of the solver refer to the overlap which is about to
+        // be deleted. the same applies to the solver itself because it refers to the
+        // parallel scalar product.
+        workspace_.clear();
+        bicgstabSolver_.reset();
+        convCrit_.reset();
+
+        ParentType::cleanup_();
+    }
+
     std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
                                                     ParallelScalarProduct& parScalarProduct,
                                                     ParallelPreconditioner& parPreCond)
     {
-        const auto& gridView = this->simulator_.gridView();
-        typedef CombinedCriterion<OverlappingVector, decltype(gridView.comm())> CCC;
-
         Scalar linearSolverTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
         Scalar linearSolverAbsTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverAbsTolerance);
         if(linearSolverAbsTolerance < 0.0)
             linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance() / 100.0;
 
-        convCrit_.reset(new CCC(gridView.comm(),
-                                /*residualReductionTolerance=*/linearSolverTolerance,
-                                /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
-                                EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverMaxError)));
-
-        auto bicgstabSolver =
-            std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct);
-
-        int verbosity = 0;
-        if (parOperator.overlap().myRank() == 0)
-            verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
-        bicgstabSolver->setVerbosity(verbosity);
-        bicgstabSolver->setMaxIterations(EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations));
-        bicgstabSolver->setLinearOperator(&parOperator);
-        bicgstabSolver->setRhs(this->overlappingb_);
-
-        return bicgstabSolver;
+        // the solver and its convergence criterion are kept until the structure of the
+        // linear system changes. only the objects which may change between two linear
+        // solves are updated.
+        if (!bicgstabSolver_) {
+            convCrit_.reset(new LinearSolverCriterion(this->simulator_.gridView().comm(),
+                                                      /*residualReductionTolerance=*/linearSolverTolerance,
+                                                      /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
+                                                      EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverMaxError)));
+
+            bicgstabSolver_ =
+                std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct);
+
+            int verbosity = 0;
+            if (parOperator.overlap().myRank() == 0)
+                verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+            bicgstabSolver_->setVerbosity(verbosity);
+            bicgstabSolver_->setMaxIterations(EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations));
+            bicgstabSolver_->setFuseReductions(EWOMS_GET_PARAM(TypeTag, bool, LinearSolverFuseReductions));
+            bicgstabSolver_->setWorkspace(&workspace_);
+        }
+        else {
+            // the absolute tolerance may depend on the tolerance of the Newton method
+            convCrit_->setResidualReductionTolerance(linearSolverTolerance);
+            convCrit_->setAbsResidualTolerance(linearSolverAbsTolerance);
+            bicgstabSolver_->setPreconditioner(parPreCond);
+        }
+
+        bicgstabSolver_->setLinearOperator(&parOperator);
+        bicgstabSolver_->setRhs(this->overlappingb_);
+
+        return bicgstabSolver_;
     }
 
     std::pair<bool,int> runSolver_(std::shared_ptr<RawLinearSolver> solver)
@@ -162,7 +196,9 @@ protected:
     void cleanupSolver_()
     { /* nothing to do */ }
 
-    std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
+    std::shared_ptr<RawLinearSolver> bicgstabSolver_;
+    std::unique_ptr<LinearSolverCriterion> convCrit_;
+    typename RawLinearSolver::Workspace workspace_;
 };
 
 }} // namespace Linear, Ewoms
@@ -0,0 +1,241 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::SparsityPattern
+ */
+#ifndef EWOMS_SPARSITY_PATTERN_HH
+#define EWOMS_SPARSITY_PATTERN_HH
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ * \brief Compressed row storage representation of the sparsity pattern of a matrix.
+ *
+ * The pattern is built in two phases: First, an upper bound for the number of entries
+ * of each row is announced using reserveEntries(). After allocate() has been called,
+ * the entries are then added using addReservedEntry(). Both of these methods may be
+ * called concurrently by multiple OpenMP threads. Duplicate entries are fine, they are
+ * removed by finalize(), which also sorts the column indices of each row.
+ *
+ * Additional entries for which no space has been reserved can be added using
+ * addEntry() at any time before finalize() is called. This method is not thread-safe
+ * and it is intended to be used by the auxiliary modules.
+ */
+class SparsityPattern
+{
+public:
+    SparsityPattern(size_t numRows = 0)
+    { reset(numRows); }
+
+    /*!
+     * \brief Clear the pattern and set the number of rows.
+     */
+    void reset(size_t numRows)
+    {
+        numRows_ = numRows;
+        rowSize_.assign(numRows, 0);
+        rowOffset_.assign(numRows + 1, 0);
+        columnIndices_.clear();
+        extraEntries_.clear();
+        finalized_ = false;
+    }
+
+    /*!
+     * \brief Returns the number of rows of the pattern.
+     */
+    size_t numRows() const
+    { return numRows_; }
+
+    /*!
+     * \brief Announce that at most 'numEntries' additional entries will be added to a
+     *        row using addReservedEntry().
+     *
+     * This method is thread-safe.
+     */
+    void reserveEntries(unsigned rowIdx, unsigned numEntries)
+    {
+        assert(rowIdx < numRows_);
+
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        rowSize_[rowIdx] += numEntries;
+    }
+
+    /*!
+     * \brief Allocate the memory for the entries announced via reserveEntries().
+     */
+    void allocate()
+    {
+        rowOffset_[0] = 0;
+        for (size_t rowIdx = 0; rowIdx < numRows_; ++rowIdx) {
+            rowOffset_[rowIdx + 1] = rowOffset_[rowIdx] + rowSize_[rowIdx];
+            rowSize_[rowIdx] = 0;
+        }
+
+        columnIndices_.resize(rowOffset_[numRows_]);
+    }
+
+    /*!
+     * \brief Add an entry for which space has been reserved before.
+     *
+     * This method is thread-safe.
+     */
+    void addReservedEntry(unsigned rowIdx, unsigned colIdx)
+    {
+        assert(rowIdx < numRows_);
+
+        unsigned pos;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+        pos = rowSize_[rowIdx]++;
+
+        assert(rowOffset_[rowIdx] + pos < rowOffset_[rowIdx + 1]);
+        columnIndices_[rowOffset_[rowIdx] + pos] = colIdx;
+    }
+
+    /*!
+     * \brief Add an entry for which no space was reserved.
+     *
+     * This method is not thread-safe.
+     */
+    void addEntry(unsigned rowIdx, unsigned colIdx)
+    {
+        assert(rowIdx < numRows_);
+        extraEntries_.emplace_back(rowIdx, colIdx);
+    }
+
+    /*!
+     * \brief Sort the column indices of each row and remove all duplicates.
+     *
+     * After this method has been called, no entries can be added anymore.
+     */
+    void finalize()
+    {
+        // sort the additional entries by row so that they can be merged efficiently
+        std::sort(extraEntries_.begin(), extraEntries_.end());
+        std::vector<size_t> extraOffset(numRows_ + 1, 0);
+        for (const auto& entry : extraEntries_)
+            ++ extraOffset[entry.first + 1];
+        for (size_t rowIdx = 0; rowIdx < numRows_; ++rowIdx)
+            extraOffset[rowIdx + 1] += extraOffset[rowIdx];
+
+        // merge the additional entries into the rows. we first compute an upper bound
+        // of the size of each row.
+        std::vector<size_t> tmpOffset(numRows_ + 1, 0);
+        for (size_t rowIdx = 0; rowIdx < numRows_; ++rowIdx)
+            tmpOffset[rowIdx + 1] =
+                tmpOffset[rowIdx]
+                + rowSize_[rowIdx]
+                + (extraOffset[rowIdx + 1] - extraOffset[rowIdx]);
+
+        std::vector<unsigned> tmpColumnIndices(tmpOffset[numRows_]);
+        int numRows = static_cast<int>(numRows_);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < numRows; ++i) {
+            size_t rowIdx = static_cast<size_t>(i);
+            auto rowBegin = tmpColumnIndices.begin() + static_cast<long>(tmpOffset[rowIdx]);
+            auto rowIt = std::copy(columnIndices_.begin() + static_cast<long>(rowOffset_[rowIdx]),
+                                   columnIndices_.begin() + static_cast<long>(rowOffset_[rowIdx] + rowSize_[rowIdx]),
+                                   rowBegin);
+            for (size_t j = extraOffset[rowIdx]; j < extraOffset[rowIdx + 1]; ++j, ++rowIt)
+                *rowIt = extraEntries_[j].second;
+
+            std::sort(rowBegin, rowIt);
+            rowSize_[rowIdx] = static_cast<unsigned>(std::unique(rowBegin, rowIt) - rowBegin);
+        }
+
+        // compress the result
+        rowOffset_[0] = 0;
+        for (size_t rowIdx = 0; rowIdx < numRows_; ++rowIdx)
+            rowOffset_[rowIdx + 1] = rowOffset_[rowIdx] + rowSize_[rowIdx];
+
+        columnIndices_.resize(rowOffset_[numRows_]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < numRows; ++i) {
+            size_t rowIdx = static_cast<size_t>(i);
+            std::copy(tmpColumnIndices.begin() + static_cast<long>(tmpOffset[rowIdx]),
+                      tmpColumnIndices.begin() + static_cast<long>(tmpOffset[rowIdx] + rowSize_[rowIdx]),
+                      columnIndices_.begin() + static_cast<long>(rowOffset_[rowIdx]));
+        }
+
+        extraEntries_.clear();
+        extraEntries_.shrink_to_fit();
+        finalized_ = true;
+    }
+
+    /*!
+     * \brief Returns the number of entries of a row.
+     *
+     * This method may only be called after finalize().
+     */
+    size_t rowSize(size_t rowIdx) const
+    {
+        assert(finalized_);
+        return rowSize_[rowIdx];
+    }
+
+    /*!
+     * \brief Returns a pointer to the sorted column indices of a row.
+     *
+     * This method may only be called after finalize().
+     */
+    const unsigned* rowBegin(size_t rowIdx) const
+    {
+        assert(finalized_);
+        return columnIndices_.data() + rowOffset_[rowIdx];
+    }
+
+    /*!
+     * \brief Returns a pointer after the last column index of a row.
+     *
+     * This method may only be called after finalize().
+     */
+    const unsigned* rowEnd(size_t rowIdx) const
+    { return rowBegin(rowIdx) + rowSize(rowIdx); }
+
+private:
+    size_t numRows_;
+    std::vector<unsigned> rowSize_;
+    std::vector<size_t> rowOffset_;
+    std::vector<unsigned> columnIndices_;
+    std::vector<std::pair<unsigned, unsigned> > extraEntries_;
+    bool finalized_;
+};
+
+}} // namespace Linear, Opm
+
+#endif
@@ -38,6 +38,8 @@
 #include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
 
+#include <stdexcept>
+
 BEGIN_PROPERTIES
 
 // forward declaration of the required property tags
@@ -74,6 +76,7 @@ class SuperLUBackend
 
 public:
     SuperLUBackend(Simulator& simulator OPM_UNUSED)
+        : M_(nullptr)
     {}
 
     static void registerParameters()
@@ -100,11 +103,23 @@ public:
     void getResidual(Vector& b) const
     { b = *b_; }
 
+    /*!
+     * \brief Specify the matrix of the linear system.
+     *
+     * Only a reference to the matrix is kept. If solve() is called again without
+     * calling this method, the matrix passed by the previous call is factorized again.
+     */
     void setMatrix(const SparseMatrixAdapter& M)
     { M_ = &M; }
 
     bool solve(Vector& x)
-    { return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_); }
+    {
+        if (!M_)
+            throw std::logic_error("The matrix must be specified using setMatrix() before "
+                                   "the linear system can be solved");
+
+        return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_);
+    }
 
 private:
     const Matrix* M_;
@@ -28,6 +28,7 @@
 #define EWOMS_WEIGHTED_RESIDUAL_REDUCTION_CRITERION_HH
 
 #include "convergencecriterion.hh"
+#include "krylovkernels.hh"
 
 #include <iostream>
 
@@ -254,23 +255,32 @@ private:
     // update the weighted absolute residual
     void updateErrors_(const Vector& curSol, const Vector& curResid)
     {
-        residualError_ = 0.0;
-        fixPointError_ = 0.0;
-        for (size_t i = 0; i < curResid.size(); ++i) {
+        // the maximum norms are insensitive to the entries which are shared with other
+        // processes, so all local rows can be considered.
+        Scalar residualError = 0.0;
+        Scalar fixPointError = 0.0;
+        const long n = static_cast<long>(curResid.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(max: residualError, fixPointError) \
+    if (n >= long(KrylovKernels::minRowsPerThreadedKernel))
+#endif
+        for (long i = 0; i < n; ++i) {
             for (unsigned j = 0; j < BlockType::dimension; ++j) {
-                residualError_ =
-                    std::max<Scalar>(residualError_,
-                                     residualWeight(i, j)*std::abs(curResid[i][j]));
-                fixPointError_ =
-                    std::max<Scalar>(fixPointError_,
+                residualError =
+                    std::max<Scalar>(residualError,
+                                     residualWeight(static_cast<size_t>(i), j)*std::abs(curResid[i][j]));
+                fixPointError =
+                    std::max<Scalar>(fixPointError,
                                      std::abs(curSol[i][j] - lastSolVec_[i][j])
                                      /std::max<Scalar>(1.0, curSol[i][j]));
             }
         }
         lastSolVec_ = curSol;
 
-        residualError_ = comm_.max(residualError_);
-        fixPointError_ = comm_.max(fixPointError_);
+        Scalar reduced[2] = { residualError, fixPointError };
+        comm_.max(reduced, 2);
+        residualError_ = reduced[0];
+        fixPointError_ = reduced[1];
     }
 
     const CollectiveCommunication& comm_;
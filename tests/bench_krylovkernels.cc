@@ -0,0 +1,156 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Micro-benchmark for the vector kernels used by the Krylov solvers.
+ *
+ * The kernels of Opm::Linear::KrylovKernels are compared to the same operations
+ * expressed using the block vector operations of dune-istl. The number of rows and
+ * the number of repetitions can be specified as the first and second command line
+ * arguments. The number of threads is controlled by the OMP_NUM_THREADS environment
+ * variable.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/krylovkernels.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/istl/bvector.hh>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+typedef Dune::FieldVector<double, 3> Block;
+typedef Dune::BlockVector<Block> Vector;
+
+template <class Fn>
+double measure(const char* name, unsigned numReps, Fn fn)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned repIdx = 0; repIdx < numReps; ++repIdx)
+        fn();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count()/numReps;
+    std::cout << "  " << name << ": " << seconds*1e3 << " ms\n";
+    return seconds;
+}
+
+void fill(Vector& v, double offset)
+{
+    for (size_t i = 0; i < v.size(); ++i)
+        for (size_t k = 0; k < Block::dimension; ++k)
+            v[i][k] = std::sin(offset + 3.0*i + k);
+}
+
+double maxDifference(const Vector& a, const Vector& b)
+{
+    double result = 0.0;
+    for (size_t i = 0; i < a.size(); ++i)
+        for (size_t k = 0; k < Block::dimension; ++k)
+            result = std::max(result, std::abs(a[i][k] - b[i][k]));
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    size_t numRows = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    unsigned numReps = (argc > 2) ? unsigned(std::strtoul(argv[2], nullptr, 10)) : 20;
+
+    std::cout << "Benchmarking the Krylov kernels for " << numRows << " rows of "
+              << Block::dimension << " entries and " << numReps << " repetitions\n";
+
+    Vector r(numRows), v(numRows), y(numRows), pRef(numRows), p(numRows);
+    Vector hRef(numRows), h(numRows), sRef(numRows), s(numRows);
+    fill(r, 0.1);
+    fill(v, 0.2);
+    fill(y, 0.3);
+    fill(pRef, 0.4);
+    fill(hRef, 0.5);
+    fill(sRef, 0.6);
+    p = pRef;
+    h = hRef;
+    s = sRef;
+
+    const double alpha = 1e-3;
+    const double beta = 0.5;
+    const double omega = 0.25;
+    bool success = true;
+
+    // p = r + beta*(p - omega*v)
+    std::cout << "search direction:\n";
+    measure("dune-istl", numReps, [&]() {
+            pRef.axpy(-omega, v);
+            pRef *= beta;
+            pRef += r;
+        });
+    measure("fused", numReps, [&]() {
+            Opm::Linear::KrylovKernels::bicgstabSearchDirection(p, r, v, beta, omega);
+        });
+    success = success && maxDifference(p, pRef) < 1e-8;
+
+    // h += alpha*y, s -= alpha*v
+    std::cout << "intermediate solution and residual:\n";
+    measure("dune-istl", numReps, [&]() {
+            hRef.axpy(alpha, y);
+            sRef.axpy(-alpha, v);
+        });
+    measure("fused", numReps, [&]() {
+            Opm::Linear::KrylovKernels::bicgstabIntermediate(h, s, y, v, alpha);
+        });
+    success = success && maxDifference(h, hRef) < 1e-8 && maxDifference(s, sRef) < 1e-8;
+
+    // four scalar products over all rows
+    std::cout << "four scalar products:\n";
+    std::vector<int> rowIndices(numRows);
+    std::iota(rowIndices.begin(), rowIndices.end(), 0);
+    std::array<double, 4> dotsRef;
+    std::array<double, 4> dots;
+    measure("dune-istl", numReps, [&]() {
+            dotsRef[0] = r.dot(r);
+            dotsRef[1] = r.dot(v);
+            dotsRef[2] = y.dot(v);
+            dotsRef[3] = y.dot(r);
+        });
+    measure("fused", numReps, [&]() {
+            Opm::Linear::KrylovKernels::dots(dots,
+                                             std::array<const Vector*, 4>{{&r, &r, &y, &y}},
+                                             std::array<const Vector*, 4>{{&r, &v, &v, &r}},
+                                             rowIndices);
+        });
+    for (size_t dotIdx = 0; dotIdx < dots.size(); ++dotIdx)
+        success = success && std::abs(dots[dotIdx] - dotsRef[dotIdx]) <= 1e-8*(1.0 + std::abs(dotsRef[dotIdx]));
+
+    if (!success) {
+        std::cout << "The results of the fused kernels differ from the reference!\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the bits of an Opm::AtomicBitVector can be concurrently
+ *        modified by multiple threads.
+ */
+#include "config.h"
+
+#include <opm/models/parallel/atomicbitvector.hh>
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    const unsigned numThreads = 8;
+    const size_t numBits = 1000;
+
+    Opm::AtomicBitVector bits;
+    bits.resize(numBits, /*value=*/false);
+
+    // each thread sets every numThreads-th bit, i.e., all threads write to the same
+    // words concurrently
+    std::vector<std::thread> threads;
+    for (unsigned threadIdx = 0; threadIdx < numThreads; ++threadIdx)
+        threads.emplace_back([&bits, threadIdx]() {
+                for (size_t bitIdx = threadIdx; bitIdx < numBits; bitIdx += numThreads)
+                    bits.set(bitIdx);
+            });
+    for (auto& thread : threads)
+        thread.join();
+    threads.clear();
+
+    for (size_t bitIdx = 0; bitIdx < numBits; ++bitIdx) {
+        if (!bits.test(bitIdx)) {
+            std::cout << "Bit " << bitIdx << " was not set\n";
+            return 1;
+        }
+    }
+
+    // all threads try to claim all bits. each bit must be claimed exactly once.
+    bits.fill(/*value=*/false);
+    std::atomic<size_t> numClaimed(0);
+    for (unsigned threadIdx = 0; threadIdx < numThreads; ++threadIdx)
+        threads.emplace_back([&bits, &numClaimed]() {
+                for (size_t bitIdx = 0; bitIdx < numBits; ++bitIdx)
+                    if (!bits.testAndSet(bitIdx))
+                        ++numClaimed;
+            });
+    for (auto& thread : threads)
+        thread.join();
+
+    if (numClaimed != numBits) {
+        std::cout << numClaimed << " bits were claimed, expected " << numBits << "\n";
+        return 1;
+    }
+
+    // copies must be independent of the original
+    Opm::AtomicBitVector copy(bits);
+    bits.reset(42);
+    if (!copy.test(42) || bits.test(42) || copy.size() != numBits) {
+        std::cout << "Copying the bit vector failed\n";
+        return 1;
+    }
+
+    // swapping must exchange the contents of the vectors
+    Opm::AtomicBitVector other;
+    other.resize(10, /*value=*/false);
+    other.swap(copy);
+    if (other.size() != numBits || copy.size() != 10 || !other.test(42) || copy.test(0)) {
+        std::cout << "Swapping bit vectors failed\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that Opm::Linear::BiCGStabSolver yields the same solution if the
+ *        scalar products of an iteration are fused.
+ *
+ * The fused variant computes (r0hat, r) by a recurrence instead of an explicit scalar
+ * product. This is checked for a scalar product which provides a dots() method as well
+ * as for one which does not, i.e., for which the solver falls back to computing the
+ * scalar products one after another.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/bicgstabsolver.hh>
+#include <opm/simulators/linalg/residreductioncriterion.hh>
+#include <opm/simulators/linalg/krylovkernels.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/scalarproducts.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/version.hh>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+typedef Dune::FieldMatrix<double, 1, 1> MatrixBlock;
+typedef Dune::BCRSMatrix<MatrixBlock> Matrix;
+typedef Dune::BlockVector<Dune::FieldVector<double, 1> > Vector;
+
+/*!
+ * \brief A sequential scalar product which does not provide a dots() method.
+ */
+class SequentialScalarProduct : public Dune::ScalarProduct<Vector>
+{
+public:
+    typedef double field_type;
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2, 5)
+    typedef typename Dune::ScalarProduct<Vector>::real_type real_type;
+#else
+    typedef double real_type;
+#endif
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,6)
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+#else
+    enum { category = Dune::SolverCategory::sequential };
+#endif
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+    field_type dot(const Vector& x, const Vector& y) const override
+#else
+    field_type dot(const Vector& x, const Vector& y) override
+#endif
+    { return x.dot(y); }
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+    real_type norm(const Vector& x) const override
+#else
+    real_type norm(const Vector& x) override
+#endif
+    { return x.two_norm(); }
+};
+
+/*!
+ * \brief A sequential scalar product which computes several scalar products at once.
+ */
+class FusingScalarProduct : public SequentialScalarProduct
+{
+public:
+    FusingScalarProduct(size_t numRows)
+        : rowIndices_(numRows)
+        , numDotsCalls_(0)
+    {
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            rowIndices_[rowIdx] = static_cast<unsigned>(rowIdx);
+    }
+
+    template <size_t numDots>
+    void dots(std::array<field_type, numDots>& result,
+              const std::array<const Vector*, numDots>& x,
+              const std::array<const Vector*, numDots>& y)
+    {
+        Opm::Linear::KrylovKernels::dots(result, x, y, rowIndices_);
+        ++ numDotsCalls_;
+    }
+
+    unsigned numDotsCalls() const
+    { return numDotsCalls_; }
+
+private:
+    std::vector<unsigned> rowIndices_;
+    unsigned numDotsCalls_;
+};
+
+/*!
+ * \brief The linear operator which applies the matrix.
+ */
+class MatrixOperator
+{
+public:
+    typedef double field_type;
+
+    MatrixOperator(const Matrix& A)
+        : A_(A)
+    {}
+
+    void apply(const Vector& x, Vector& y) const
+    { A_.mv(x, y); }
+
+private:
+    const Matrix& A_;
+};
+
+/*!
+ * \brief A Jacobi preconditioner.
+ */
+class JacobiPreconditioner
+{
+public:
+    JacobiPreconditioner(const Matrix& A)
+        : invDiag_(A.N())
+    {
+        for (size_t rowIdx = 0; rowIdx < A.N(); ++rowIdx)
+            invDiag_[rowIdx] = 1.0/A[rowIdx][rowIdx][0][0];
+    }
+
+    void pre(Vector&, Vector&)
+    {}
+
+    void apply(Vector& v, const Vector& d)
+    {
+        for (size_t rowIdx = 0; rowIdx < v.size(); ++rowIdx)
+            v[rowIdx][0] = invDiag_[rowIdx]*d[rowIdx][0];
+    }
+
+    void post(Vector&)
+    {}
+
+private:
+    std::vector<double> invDiag_;
+};
+
+// the matrix of an upwinded 1D convection-diffusion problem, which is not symmetric
+void assembleMatrix(Matrix& A)
+{
+    const size_t numRows = A.N();
+    for (auto rowIt = A.createbegin(); rowIt != A.createend(); ++rowIt) {
+        size_t rowIdx = rowIt.index();
+        if (rowIdx > 0)
+            rowIt.insert(rowIdx - 1);
+        rowIt.insert(rowIdx);
+        if (rowIdx + 1 < numRows)
+            rowIt.insert(rowIdx + 1);
+    }
+
+    A = 0.0;
+    for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        A[rowIdx][rowIdx] = 2.5;
+        if (rowIdx > 0)
+            A[rowIdx][rowIdx - 1] = -1.5;
+        if (rowIdx + 1 < numRows)
+            A[rowIdx][rowIdx + 1] = -0.5;
+    }
+}
+
+template <class ScalarProduct>
+bool solve(Vector& x,
+           const Matrix& A,
+           const Vector& b,
+           ScalarProduct& scalarProduct,
+           bool fuseReductions)
+{
+    typedef Opm::Linear::BiCGStabSolver<MatrixOperator,
+                                        Vector,
+                                        JacobiPreconditioner,
+                                        ScalarProduct> Solver;
+
+    MatrixOperator op(A);
+    JacobiPreconditioner preconditioner(A);
+    Opm::Linear::ResidReductionCriterion<Vector> criterion(scalarProduct, /*tolerance=*/1e-12);
+
+    Solver solver(preconditioner, criterion, scalarProduct);
+    solver.setLinearOperator(&op);
+    solver.setRhs(&b);
+    solver.setMaxIterations(500);
+    solver.setVerbosity(0);
+    solver.setFuseReductions(fuseReductions);
+
+    if (!solver.apply(x)) {
+        std::cerr << "The BiCGStab solver did not converge "
+                  << (fuseReductions ? "with" : "without") << " fused reductions\n";
+        return false;
+    }
+
+    // make sure that the solution actually solves the linear system
+    Vector residual(b);
+    A.mmv(x, residual);
+    if (residual.two_norm() > 1e-10*b.two_norm()) {
+        std::cerr << "The residual of the solution is too large "
+                  << (fuseReductions ? "with" : "without") << " fused reductions: "
+                  << residual.two_norm() << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool solutionsClose(const Vector& a, const Vector& b)
+{
+    Vector diff(a);
+    diff -= b;
+    return diff.infinity_norm() <= 1e-8*a.infinity_norm();
+}
+
+int main()
+{
+    const size_t numRows = 1000;
+
+    Matrix A(numRows, numRows, 3*numRows, Matrix::row_wise);
+    assembleMatrix(A);
+
+    Vector b(numRows);
+    for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        b[rowIdx] = std::sin(0.1*static_cast<double>(rowIdx)) + 1.0;
+
+    // the reference uses the conventional algorithm
+    SequentialScalarProduct sequentialScalarProduct;
+    Vector referenceSolution(numRows);
+    if (!solve(referenceSolution, A, b, sequentialScalarProduct, /*fuseReductions=*/false))
+        return 1;
+
+    // fused reductions, but the scalar products are computed one after another because
+    // the scalar product does not provide dots()
+    Vector fallbackSolution(numRows);
+    if (!solve(fallbackSolution, A, b, sequentialScalarProduct, /*fuseReductions=*/true))
+        return 1;
+    if (!solutionsClose(referenceSolution, fallbackSolution)) {
+        std::cerr << "The solution using fused reductions without dots() differs from the "
+                  << "one of the conventional algorithm\n";
+        return 1;
+    }
+
+    // fused reductions which are actually computed using a single call to dots()
+    FusingScalarProduct fusingScalarProduct(numRows);
+    Vector fusedSolution(numRows);
+    if (!solve(fusedSolution, A, b, fusingScalarProduct, /*fuseReductions=*/true))
+        return 1;
+    if (fusingScalarProduct.numDotsCalls() == 0) {
+        std::cerr << "The fused scalar products have not been computed using dots()\n";
+        return 1;
+    }
+    if (!solutionsClose(referenceSolution, fusedSolution)) {
+        std::cerr << "The solution using fused reductions differs from the one of the "
+                  << "conventional algorithm\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the Opm::Linear::BlockIlu0Preconditioner produces correct
+ *        results for all block sizes used by the models.
+ *
+ * For block tridiagonal matrices, ILU(0) does not drop any entries, i.e., applying
+ * the preconditioner must solve the linear system exactly. This is also checked for
+ * factors which are stored in single precision.
+ *
+ * Since the substitution levels of tridiagonal matrices only consist of a single row,
+ * the preconditioner is also applied to the matrix of a 7-point stencil on a 3D
+ * structured grid. Its levels are large enough to be processed by multiple threads
+ * and its factorization drops entries. The result is compared to the one of
+ * Dune::SeqILU0.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/blockilu0preconditioner.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/common/fvector.hh>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+template <int numEq, class FactorScalar = double>
+bool testBlockSize(double tolerance = 1e-10)
+{
+    typedef Opm::MatrixBlock<double, numEq, numEq> MatrixBlock;
+    typedef Dune::BCRSMatrix<MatrixBlock> Matrix;
+    typedef Dune::BlockVector<Dune::FieldVector<double, numEq> > Vector;
+    typedef Opm::Linear::BlockIlu0Preconditioner<Matrix, Vector, Vector, FactorScalar> Preconditioner;
+
+    // assemble a diagonally dominant block tridiagonal matrix which is not symmetric
+    const size_t numRows = 2000;
+    Matrix A(numRows, numRows, 3*numRows, Matrix::row_wise);
+    for (auto rowIt = A.createbegin(); rowIt != A.createend(); ++rowIt) {
+        size_t rowIdx = rowIt.index();
+        if (rowIdx > 0)
+            rowIt.insert(rowIdx - 1);
+        rowIt.insert(rowIdx);
+        if (rowIdx + 1 < numRows)
+            rowIt.insert(rowIdx + 1);
+    }
+
+    for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        for (auto colIt = A[rowIdx].begin(); colIt != A[rowIdx].end(); ++colIt) {
+            size_t colIdx = colIt.index();
+            for (int i = 0; i < numEq; ++i) {
+                for (int j = 0; j < numEq; ++j) {
+                    double value = 0.1*std::sin(1.0 + rowIdx + 2.0*colIdx + 3.0*i + 5.0*j);
+                    if (colIdx == rowIdx && i == j)
+                        value += 4.0*numEq;
+                    (*colIt)[i][j] = value;
+                }
+            }
+        }
+    }
+
+    Vector d(numRows);
+    for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        for (int i = 0; i < numEq; ++i)
+            d[rowIdx][i] = std::cos(0.3*rowIdx + i);
+
+    Preconditioner preconditioner(A, /*relaxationFactor=*/1.0);
+    for (unsigned updateIdx = 0; updateIdx < 2; ++updateIdx) {
+        if (updateIdx > 0) {
+            // a new factorization of a scaled matrix must yield a scaled solution
+            A *= 2.0;
+            preconditioner.update(A);
+        }
+
+        Vector v(numRows);
+        v = 0.0;
+        preconditioner.apply(v, d);
+
+        // compute the residual d - A*v
+        Vector residual(d);
+        A.mmv(v, residual);
+
+        double maxResidual = residual.infinity_norm();
+        if (!(maxResidual < tolerance)) {
+            std::cout << "The block ILU(0) preconditioner does not solve a block tridiagonal system "
+                      << "exactly for " << numEq << " equations and "
+                      << 8*sizeof(FactorScalar) << " bit factors (update " << updateIdx
+                      << ", residual: " << maxResidual << ")\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <int numEq, class FactorScalar = double>
+bool testAgainstSeqIlu0(double tolerance = 1e-12)
+{
+    typedef Opm::MatrixBlock<double, numEq, numEq> MatrixBlock;
+    typedef Dune::BCRSMatrix<MatrixBlock> Matrix;
+    typedef Dune::BlockVector<Dune::FieldVector<double, numEq> > Vector;
+    typedef Opm::Linear::BlockIlu0Preconditioner<Matrix, Vector, Vector, FactorScalar> Preconditioner;
+    typedef Dune::SeqILU0<Matrix, Vector, Vector> ReferencePreconditioner;
+
+    // assemble a non-symmetric matrix for the 7-point stencil of a structured grid.
+    // the rows with the same sum of the cell indices in the three directions form
+    // one level of the substitutions, i.e., most levels contain many more rows than
+    // the threshold above which they are processed by multiple threads.
+    const int n = 32;
+    const size_t numRows = n*n*n;
+    auto cellIdx = [n](int i, int j, int k) -> size_t
+        { return static_cast<size_t>(i + n*(j + n*k)); };
+
+    Matrix A(numRows, numRows, 7*numRows, Matrix::row_wise);
+    for (auto rowIt = A.createbegin(); rowIt != A.createend(); ++rowIt) {
+        int i = static_cast<int>(rowIt.index() % n);
+        int j = static_cast<int>((rowIt.index()/n) % n);
+        int k = static_cast<int>(rowIt.index()/(n*n));
+        if (k > 0)
+            rowIt.insert(cellIdx(i, j, k - 1));
+        if (j > 0)
+            rowIt.insert(cellIdx(i, j - 1, k));
+        if (i > 0)
+            rowIt.insert(cellIdx(i - 1, j, k));
+        rowIt.insert(rowIt.index());
+        if (i + 1 < n)
+            rowIt.insert(cellIdx(i + 1, j, k));
+        if (j + 1 < n)
+            rowIt.insert(cellIdx(i, j + 1, k));
+        if (k + 1 < n)
+            rowIt.insert(cellIdx(i, j, k + 1));
+    }
+
+    for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        for (auto colIt = A[rowIdx].begin(); colIt != A[rowIdx].end(); ++colIt) {
+            size_t colIdx = colIt.index();
+            for (int i = 0; i < numEq; ++i) {
+                for (int j = 0; j < numEq; ++j) {
+                    double value = 0.1*std::sin(1.0 + rowIdx + 2.0*colIdx + 3.0*i + 5.0*j);
+                    if (colIdx == rowIdx && i == j)
+                        value += 8.0*numEq;
+                    else if (colIdx != rowIdx && i == j)
+                        value -= 1.0;
+                    (*colIt)[i][j] = value;
+                }
+            }
+        }
+    }
+
+    Vector d(numRows);
+    for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        for (int i = 0; i < numEq; ++i)
+            d[rowIdx][i] = std::cos(0.3*rowIdx + i);
+
+    const double relaxationFactor = 0.9;
+    Preconditioner preconditioner(A, relaxationFactor);
+    ReferencePreconditioner referencePreconditioner(A, relaxationFactor);
+
+    Vector v(numRows);
+    v = 0.0;
+    preconditioner.apply(v, d);
+
+    Vector vRef(numRows);
+    vRef = 0.0;
+    referencePreconditioner.apply(vRef, d);
+
+    Vector diff(v);
+    diff -= vRef;
+    double maxDiff = diff.infinity_norm();
+    if (!(maxDiff <= tolerance*vRef.infinity_norm())) {
+        std::cout << "The block ILU(0) preconditioner differs from Dune::SeqILU0 for the "
+                  << "7-point stencil matrix for " << numEq << " equations and "
+                  << 8*sizeof(FactorScalar) << " bit factors (maximum difference: "
+                  << maxDiff << ")\n";
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+#ifdef _OPENMP
+    // make sure that the levels of the substitutions are processed by multiple threads
+    // even if the test is run on a machine with a single core
+    omp_set_num_threads(std::max(omp_get_max_threads(), 4));
+#endif
+
+    bool success =
+        testBlockSize<1>()
+        && testBlockSize<2>()
+        && testBlockSize<3>()
+        && testBlockSize<4>()
+        && testBlockSize<5>()
+        && testBlockSize<6>()
+        // if the factors are stored in single precision, the solution is only exact up
+        // to the rounding errors of the factors
+        && testBlockSize<1, float>(1e-5)
+        && testBlockSize<3, float>(1e-5)
+        && testAgainstSeqIlu0<1>()
+        && testAgainstSeqIlu0<3>()
+        && testAgainstSeqIlu0<3, float>(1e-5);
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief This test makes sure that the colored linearization of the global system of
+ *        equations yields the same result as the conventional one and that its result
+ *        does not depend on the number of threads.
+ *
+ * For this, the lens problem is linearized using the vertex-centered finite volume
+ * discretization (which requires more than one color). The result of the colored
+ * linearization is compared to the one of the linearization with
+ * EnableColoredLinearization=false. Since the contributions of the elements are added
+ * in a different order, this comparison uses a relative tolerance. Also, the colored
+ * linearization is done once with multiple threads and once with a single thread and
+ * the resulting Jacobian matrices and residuals are compared bit by bit.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/immiscible/immisciblemodel.hh>
+#include "problems/lensproblem.hh"
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+BEGIN_PROPERTIES
+
+NEW_TYPE_TAG(LensProblemColoredLinearization, INHERITS_FROM(ImmiscibleTwoPhaseModel, LensBaseProblem));
+SET_TAG_PROP(LensProblemColoredLinearization, LocalLinearizerSplice, AutoDiffLocalLinearizer);
+SET_INT_PROP(LensProblemColoredLinearization, CellsX, 24);
+SET_INT_PROP(LensProblemColoredLinearization, CellsY, 16);
+SET_BOOL_PROP(LensProblemColoredLinearization, EnableColoredLinearization, true);
+
+// the reference problem is linearized element by element without coloring. Since the
+// parameter is not specified on the command line, its value is the default of the
+// respective type tag.
+NEW_TYPE_TAG(LensProblemUncoloredLinearization, INHERITS_FROM(LensProblemColoredLinearization));
+SET_BOOL_PROP(LensProblemUncoloredLinearization, EnableColoredLinearization, false);
+
+END_PROPERTIES
+
+template <class Vector>
+bool bitwiseEqual(const Vector& a, const Vector& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (unsigned i = 0; i < a.size(); ++i)
+        if (std::memcmp(&a[i], &b[i], sizeof(a[i])) != 0)
+            return false;
+
+    return true;
+}
+
+template <class Block>
+bool blocksClose(const Block& a, const Block& b)
+{
+    auto diff = a;
+    diff -= b;
+    return diff.infinity_norm() <= 1e-10*std::max(a.infinity_norm(), b.infinity_norm()) + 1e-30;
+}
+
+int main(int argc, char **argv)
+{
+    typedef TTAG(LensProblemColoredLinearization) TypeTag;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef TTAG(LensProblemUncoloredLinearization) ReferenceTypeTag;
+    typedef typename GET_PROP_TYPE(ReferenceTypeTag, Simulator) ReferenceSimulator;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
+    typedef typename GET_PROP_TYPE(TypeTag, SparseMatrixAdapter)::IstlMatrix IstlMatrix;
+    typedef typename GET_PROP_TYPE(TypeTag, GlobalEqVector) GlobalEqVector;
+
+    Dune::MPIHelper::instance(argc, argv);
+
+    const char* params[] = {
+        argv[0],
+        "--threads-per-process=4",
+        "--enable-vtk-output=false"
+    };
+    int paramStatus =
+        Opm::setupParameters_<TypeTag>(/*argc=*/3, params, /*registerParams=*/true);
+    if (paramStatus != 0)
+        return 1;
+
+    ThreadManager::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.model().applyInitialSolution();
+
+    auto& linearizer = simulator.model().linearizer();
+    if (!linearizer.enableColoredLinearization()) {
+        std::cerr << "The colored linearization is not enabled\n";
+        return 1;
+    }
+
+    ReferenceSimulator referenceSimulator(/*verbose=*/false);
+    referenceSimulator.model().applyInitialSolution();
+
+    auto& referenceLinearizer = referenceSimulator.model().linearizer();
+    if (referenceLinearizer.enableColoredLinearization()) {
+        std::cerr << "The colored linearization is enabled for the reference\n";
+        return 1;
+    }
+
+    // linearize without coloring
+    referenceLinearizer.linearizeDomain();
+    const IstlMatrix& referenceMatrix = referenceLinearizer.jacobian().istlMatrix();
+    const GlobalEqVector& referenceResidual = referenceLinearizer.residual();
+
+    // linearize using all threads
+    linearizer.linearizeDomain();
+    const IstlMatrix multiThreadedMatrix(linearizer.jacobian().istlMatrix());
+    const GlobalEqVector multiThreadedResidual(linearizer.residual());
+
+    if (multiThreadedResidual.size() != referenceResidual.size()) {
+        std::cerr << "The sizes of the residuals of the colored and the uncolored "
+                  << "linearization differ\n";
+        return 1;
+    }
+
+    for (unsigned dofIdx = 0; dofIdx < referenceResidual.size(); ++dofIdx) {
+        if (!blocksClose(referenceResidual[dofIdx], multiThreadedResidual[dofIdx])) {
+            std::cerr << "The residuals of the colored and the uncolored linearization "
+                      << "differ for degree of freedom " << dofIdx << "\n";
+            return 1;
+        }
+    }
+
+    auto refRowIt = referenceMatrix.begin();
+    auto coloredRowIt = multiThreadedMatrix.begin();
+    for (; refRowIt != referenceMatrix.end(); ++refRowIt, ++coloredRowIt) {
+        if (refRowIt->size() != coloredRowIt->size()) {
+            std::cerr << "The sparsity patterns of the Jacobian matrices of the colored and "
+                      << "the uncolored linearization differ\n";
+            return 1;
+        }
+
+        auto refColIt = refRowIt->begin();
+        auto coloredColIt = coloredRowIt->begin();
+        for (; refColIt != refRowIt->end(); ++refColIt, ++coloredColIt) {
+            if (refColIt.index() != coloredColIt.index()
+                || !blocksClose(*refColIt, *coloredColIt))
+            {
+                std::cerr << "The Jacobian matrices of the colored and the uncolored "
+                          << "linearization differ in row " << refRowIt.index()
+                          << ", column " << refColIt.index() << "\n";
+                return 1;
+            }
+        }
+    }
+
+    // linearize sequentially
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+    linearizer.linearizeDomain();
+    const IstlMatrix& sequentialMatrix = linearizer.jacobian().istlMatrix();
+    const GlobalEqVector& sequentialResidual = linearizer.residual();
+
+    if (!bitwiseEqual(multiThreadedResidual, sequentialResidual)) {
+        std::cerr << "The residuals of the sequential and the multi-threaded colored "
+                  << "linearization differ\n";
+        return 1;
+    }
+
+    auto seqRowIt = sequentialMatrix.begin();
+    auto mtRowIt = multiThreadedMatrix.begin();
+    for (; seqRowIt != sequentialMatrix.end(); ++seqRowIt, ++mtRowIt) {
+        if (seqRowIt->size() != mtRowIt->size()) {
+            std::cerr << "The sparsity patterns of the Jacobian matrices differ\n";
+            return 1;
+        }
+
+        auto seqColIt = seqRowIt->begin();
+        auto mtColIt = mtRowIt->begin();
+        for (; seqColIt != seqRowIt->end(); ++seqColIt, ++mtColIt) {
+            if (seqColIt.index() != mtColIt.index()
+                || std::memcmp(&(*seqColIt), &(*mtColIt), sizeof(*seqColIt)) != 0)
+            {
+                std::cerr << "The Jacobian matrices of the sequential and the multi-threaded "
+                          << "colored linearization differ in row " << seqRowIt.index()
+                          << ", column " << seqColIt.index() << "\n";
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
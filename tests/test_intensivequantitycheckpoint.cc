@@ -0,0 +1,159 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief This test makes sure that retrying failed time steps using the checkpoint of
+ *        the cached intensive quantities yields the same result as recomputing them.
+ *
+ * For this, the lens problem is simulated with the storage and the intensive quantity
+ * caches enabled and a small maximum number of Newton iterations, which causes some
+ * time steps to fail. The simulation is done once with and once without the checkpoint
+ * and the final solutions are compared.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <iostream>
+
+namespace Opm {
+/*!
+ * \brief An immiscible model which counts the failed attempts to do a time step.
+ */
+template <class TypeTag>
+class FailureCountingImmiscibleModel : public ImmiscibleModel<TypeTag>
+{
+    typedef ImmiscibleModel<TypeTag> ParentType;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+
+public:
+    FailureCountingImmiscibleModel(Simulator& simulator)
+        : ParentType(simulator)
+        , numFailedUpdates_(0)
+    { }
+
+    void updateFailed()
+    {
+        ParentType::updateFailed();
+        ++ numFailedUpdates_;
+    }
+
+    unsigned numFailedUpdates() const
+    { return numFailedUpdates_; }
+
+private:
+    unsigned numFailedUpdates_;
+};
+} // namespace Opm
+
+BEGIN_PROPERTIES
+
+NEW_TYPE_TAG(LensProblemIntensiveQuantityCheckpoint, INHERITS_FROM(LensProblemEcfvAd));
+SET_TYPE_PROP(LensProblemIntensiveQuantityCheckpoint, Model,
+              Opm::FailureCountingImmiscibleModel<TypeTag>);
+SET_BOOL_PROP(LensProblemIntensiveQuantityCheckpoint, EnableIntensiveQuantityCheckpoint, true);
+
+// the reference recomputes the intensive quantities after failed time steps. Since the
+// parameter is not specified on the command line, its value is the default of the
+// respective type tag.
+NEW_TYPE_TAG(LensProblemNoIntensiveQuantityCheckpoint, INHERITS_FROM(LensProblemIntensiveQuantityCheckpoint));
+SET_BOOL_PROP(LensProblemNoIntensiveQuantityCheckpoint, EnableIntensiveQuantityCheckpoint, false);
+
+END_PROPERTIES
+
+template <class Block>
+bool blocksClose(const Block& a, const Block& b)
+{
+    auto diff = a;
+    diff -= b;
+    return diff.infinity_norm() <= 1e-10*std::max(a.infinity_norm(), b.infinity_norm()) + 1e-30;
+}
+
+int main(int argc, char **argv)
+{
+    typedef TTAG(LensProblemIntensiveQuantityCheckpoint) TypeTag;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef TTAG(LensProblemNoIntensiveQuantityCheckpoint) ReferenceTypeTag;
+    typedef typename GET_PROP_TYPE(ReferenceTypeTag, Simulator) ReferenceSimulator;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
+
+    Dune::MPIHelper::instance(argc, argv);
+
+    // the small maximum number of Newton iterations makes the first time steps fail
+    const char* params[] = {
+        argv[0],
+        "--threads-per-process=1",
+        "--enable-vtk-output=false",
+        "--end-time=3000",
+        "--newton-max-iterations=3"
+    };
+    int paramStatus =
+        Opm::setupParameters_<TypeTag>(/*argc=*/5, params, /*registerParams=*/true);
+    if (paramStatus != 0)
+        return 1;
+
+    ThreadManager::init();
+
+    ReferenceSimulator referenceSimulator(/*verbose=*/false);
+    referenceSimulator.run();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.run();
+
+    const auto& referenceModel = referenceSimulator.model();
+    const auto& model = simulator.model();
+
+    if (referenceModel.numFailedUpdates() == 0) {
+        std::cerr << "No time step failed, the checkpoint has not been exercised\n";
+        return 1;
+    }
+
+    if (model.numFailedUpdates() != referenceModel.numFailedUpdates()) {
+        std::cerr << "The number of failed time steps differs: "
+                  << model.numFailedUpdates() << " with the checkpoint, "
+                  << referenceModel.numFailedUpdates() << " without it\n";
+        return 1;
+    }
+
+    const auto& referenceSolution = referenceModel.solution(/*timeIdx=*/0);
+    const auto& solution = model.solution(/*timeIdx=*/0);
+    if (solution.size() != referenceSolution.size()) {
+        std::cerr << "The sizes of the solutions differ\n";
+        return 1;
+    }
+
+    for (unsigned dofIdx = 0; dofIdx < referenceSolution.size(); ++dofIdx) {
+        if (!blocksClose(referenceSolution[dofIdx], solution[dofIdx])) {
+            std::cerr << "The solutions with and without the checkpoint differ for degree "
+                      << "of freedom " << dofIdx << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief This test makes sure that evaluating the residual of the global system of
+ *        equations on its own yields the same result as linearizing it.
+ *
+ * For this, the lens problem is linearized using the vertex-centered finite volume
+ * discretization and the residual is then evaluated using
+ * FvBaseLinearizer::evaluateDomainResidual(). This is done once with automatic
+ * differentiation and once with finite differences.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/immiscible/immisciblemodel.hh>
+#include "problems/lensproblem.hh"
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <iostream>
+
+BEGIN_PROPERTIES
+
+NEW_TYPE_TAG(LensProblemResidualEvaluationAd, INHERITS_FROM(ImmiscibleTwoPhaseModel, LensBaseProblem));
+SET_TAG_PROP(LensProblemResidualEvaluationAd, LocalLinearizerSplice, AutoDiffLocalLinearizer);
+SET_INT_PROP(LensProblemResidualEvaluationAd, CellsX, 24);
+SET_INT_PROP(LensProblemResidualEvaluationAd, CellsY, 16);
+
+NEW_TYPE_TAG(LensProblemResidualEvaluationFd, INHERITS_FROM(LensProblemResidualEvaluationAd));
+SET_TAG_PROP(LensProblemResidualEvaluationFd, LocalLinearizerSplice, FiniteDifferenceLocalLinearizer);
+
+END_PROPERTIES
+
+template <class Block>
+bool blocksClose(const Block& a, const Block& b)
+{
+    auto diff = a;
+    diff -= b;
+    return diff.infinity_norm() <= 1e-10*std::max(a.infinity_norm(), b.infinity_norm()) + 1e-30;
+}
+
+template <class TypeTag>
+int testResidualEvaluation(const char *progName, const char *name)
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
+    typedef typename GET_PROP_TYPE(TypeTag, GlobalEqVector) GlobalEqVector;
+
+    // the local linearizers register different parameters, so the parameter system
+    // needs to be set up from scratch for each type tag
+    EWOMS_RESET_PARAMS_(TypeTag);
+    const char* params[] = {
+        progName,
+        "--threads-per-process=1",
+        "--enable-vtk-output=false"
+    };
+    int paramStatus =
+        Opm::setupParameters_<TypeTag>(/*argc=*/3, params, /*registerParams=*/true);
+    if (paramStatus != 0)
+        return 1;
+
+    ThreadManager::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.model().applyInitialSolution();
+
+    auto& linearizer = simulator.model().linearizer();
+    linearizer.linearizeDomain();
+    const GlobalEqVector linearizedResidual(linearizer.residual());
+
+    linearizer.evaluateDomainResidual();
+    const GlobalEqVector& evaluatedResidual = linearizer.residual();
+
+    if (evaluatedResidual.size() != linearizedResidual.size()) {
+        std::cerr << name << ": The sizes of the evaluated and the linearized residual differ\n";
+        return 1;
+    }
+
+    for (unsigned dofIdx = 0; dofIdx < linearizedResidual.size(); ++dofIdx) {
+        if (!blocksClose(linearizedResidual[dofIdx], evaluatedResidual[dofIdx])) {
+            std::cerr << name << ": The evaluated and the linearized residual differ "
+                      << "for degree of freedom " << dofIdx << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    if (testResidualEvaluation<TTAG(LensProblemResidualEvaluationAd)>(argv[0], "automatic differentiation") != 0)
+        return 1;
+    if (testResidualEvaluation<TTAG(LensProblemResidualEvaluationFd)>(argv[0], "finite differences") != 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief This test makes sure that the cached finite volume geometry of the ECFV
+ *        discretization is kept up to date if the grid is adapted.
+ *
+ * For this, the finger problem is simulated with grid adaptation once with and once
+ * without the stencil cache and the final solutions are compared.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/immiscible/immisciblemodel.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+#include "problems/fingerproblem.hh"
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <iostream>
+
+BEGIN_PROPERTIES
+
+NEW_TYPE_TAG(FingerProblemEcfvStencilCache, INHERITS_FROM(ImmiscibleTwoPhaseModel, FingerBaseProblem));
+SET_TAG_PROP(FingerProblemEcfvStencilCache, SpatialDiscretizationSplice, EcfvDiscretization);
+SET_BOOL_PROP(FingerProblemEcfvStencilCache, EnableStencilCache, true);
+
+// the reference computes the geometry of the stencils on the fly
+NEW_TYPE_TAG(FingerProblemEcfvNoStencilCache, INHERITS_FROM(FingerProblemEcfvStencilCache));
+SET_BOOL_PROP(FingerProblemEcfvNoStencilCache, EnableStencilCache, false);
+
+END_PROPERTIES
+
+template <class Block>
+bool blocksClose(const Block& a, const Block& b)
+{
+    auto diff = a;
+    diff -= b;
+    return diff.infinity_norm() <= 1e-10*std::max(a.infinity_norm(), b.infinity_norm()) + 1e-30;
+}
+
+int main(int argc, char **argv)
+{
+    typedef TTAG(FingerProblemEcfvStencilCache) TypeTag;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef TTAG(FingerProblemEcfvNoStencilCache) ReferenceTypeTag;
+    typedef typename GET_PROP_TYPE(ReferenceTypeTag, Simulator) ReferenceSimulator;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
+
+    Dune::MPIHelper::instance(argc, argv);
+
+    // the grid is refined and coarsened during the simulation, so the cache must be
+    // recomputed after each adaptation
+    const char* params[] = {
+        argv[0],
+        "--threads-per-process=1",
+        "--enable-vtk-output=false",
+        "--enable-grid-adaptation=true",
+        "--end-time=2e3"
+    };
+    int paramStatus =
+        Opm::setupParameters_<TypeTag>(/*argc=*/5, params, /*registerParams=*/true);
+    if (paramStatus != 0)
+        return 1;
+
+    ThreadManager::init();
+
+    ReferenceSimulator referenceSimulator(/*verbose=*/false);
+    referenceSimulator.run();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.run();
+
+    const auto& referenceSolution = referenceSimulator.model().solution(/*timeIdx=*/0);
+    const auto& solution = simulator.model().solution(/*timeIdx=*/0);
+    if (solution.size() != referenceSolution.size()) {
+        std::cerr << "The sizes of the solutions differ: "
+                  << solution.size() << " with the stencil cache, "
+                  << referenceSolution.size() << " without it\n";
+        return 1;
+    }
+
+    for (unsigned dofIdx = 0; dofIdx < referenceSolution.size(); ++dofIdx) {
+        if (!blocksClose(referenceSolution[dofIdx], solution[dofIdx])) {
+            std::cerr << "The solutions with and without the stencil cache differ for "
+                      << "degree of freedom " << dofIdx << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the time step controllers propose the expected time step
+ *        sizes.
+ */
+#include "config.h"
+
+#include <opm/models/utils/timestepcontrol.hh>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+typedef double Scalar;
+typedef Opm::TimeStepInfo<Scalar> TimeStepInfo;
+
+static TimeStepInfo makeInfo(Scalar time,
+                             Scalar timeStepSize,
+                             int numNewtonIterations,
+                             Scalar relativeChange = 0.0)
+{
+    TimeStepInfo info;
+    info.time = time;
+    info.timeStepSize = timeStepSize;
+    info.numNewtonIterations = numNewtonIterations;
+    info.relativeChange = relativeChange;
+    return info;
+}
+
+static bool check(const std::string& what, Scalar value, Scalar expected)
+{
+    if (std::abs(value - expected) > 1e-10*std::abs(expected)) {
+        std::cout << what << ": got " << value << ", expected " << expected << "\n";
+        return false;
+    }
+    return true;
+}
+
+static bool testIterationCount()
+{
+    Opm::IterationCountTimeStepControl<Scalar> control(/*targetIterations=*/10,
+                                                       /*decayRate=*/0.75,
+                                                       /*growthRate=*/1.25);
+    bool ok = true;
+    ok = check("iteration-count, too many iterations",
+               control.nextTimeStepSize(makeInfo(0.0, 100.0, 12)), 75.0) && ok;
+    ok = check("iteration-count, too few iterations",
+               control.nextTimeStepSize(makeInfo(0.0, 100.0, 4)), 125.0) && ok;
+    ok = check("iteration-count, targeted iterations",
+               control.nextTimeStepSize(makeInfo(0.0, 100.0, 10)), 100.0) && ok;
+    ok = check("iteration-count, retry",
+               control.retryTimeStepSize(makeInfo(0.0, 100.0, 20)), 50.0) && ok;
+    return ok;
+}
+
+static bool testPid()
+{
+    const Scalar tolerance = 0.1;
+    const Scalar maxGrowth = 3.0;
+    Opm::PidTimeStepControl<Scalar> control(tolerance, maxGrowth);
+
+    bool ok = true;
+    if (!control.requiresRelativeChange()) {
+        std::cout << "pid: the relative change is not requested\n";
+        ok = false;
+    }
+
+    // hitting the tolerance exactly keeps the time step size
+    ok = check("pid, change equals the tolerance",
+               control.nextTimeStepSize(makeInfo(0.0, 100.0, 5, tolerance)), 100.0) && ok;
+
+    // exceeding the tolerance shrinks the time step size proportionally
+    ok = check("pid, change exceeds the tolerance",
+               control.nextTimeStepSize(makeInfo(100.0, 100.0, 5, 4*tolerance)), 25.0) && ok;
+
+    // tiny changes grow the time step size, but never by more than the maximum factor
+    for (int i = 0; i < 5; ++i) {
+        Scalar dt = control.nextTimeStepSize(makeInfo(200.0, 100.0, 5, 1e-10));
+        if (dt <= 100.0 || dt > maxGrowth*100.0*(1 + 1e-10)) {
+            std::cout << "pid, tiny change: got " << dt << ", expected a value in "
+                      << "(100, " << maxGrowth*100.0 << "]\n";
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+static bool testFailureAware()
+{
+    const Scalar memoryFactor = 5.0;
+    const Scalar maxGrowth = 1.25;
+    std::unique_ptr<Opm::TimeStepControlInterface<Scalar> >
+        baseControl(new Opm::IterationCountTimeStepControl<Scalar>(/*targetIterations=*/10,
+                                                                   /*decayRate=*/0.5,
+                                                                   /*growthRate=*/2.0));
+    Opm::FailureAwareTimeStepControl<Scalar> control(std::move(baseControl), memoryFactor, maxGrowth);
+
+    bool ok = true;
+
+    // the step [0, 100] fails, so it is retried with half the size
+    ok = check("failure-aware, first failure",
+               control.retryTimeStepSize(makeInfo(0.0, 100.0, 20)), 50.0) && ok;
+
+    // within the failed interval, the time step size is limited to the one which
+    // succeeded even though the underlying controller proposes to double it
+    ok = check("failure-aware, inside the failed interval",
+               control.nextTimeStepSize(makeInfo(0.0, 50.0, 4)), 50.0) && ok;
+
+    // a failure which overlaps the remembered one reduces the time step size twice
+    ok = check("failure-aware, repeated failure",
+               control.retryTimeStepSize(makeInfo(50.0, 50.0, 20)), 12.5) && ok;
+
+    // after the end of the failed interval, the failure is still remembered, i.e., the
+    // growth of the time step size is limited
+    ok = check("failure-aware, just after the failed interval",
+               control.nextTimeStepSize(makeInfo(50.0, 50.0, 4)), maxGrowth*50.0) && ok;
+    ok = check("failure-aware, shortly after the failed interval",
+               control.nextTimeStepSize(makeInfo(100.0, 62.5, 4)), maxGrowth*62.5) && ok;
+
+    // a failure after the failed interval is not treated as a repeated one
+    ok = check("failure-aware, failure after the failed interval",
+               control.retryTimeStepSize(makeInfo(200.0, 100.0, 20)), 50.0) && ok;
+
+    // once the memory of all failures has expired, the underlying controller is in
+    // charge again. the last failure ended at 300 s and lasted 100 s.
+    Scalar memoryEnd = 300.0 + memoryFactor*100.0;
+    ok = check("failure-aware, after the memory has expired",
+               control.nextTimeStepSize(makeInfo(memoryEnd - 10.0, 10.0, 4)), 20.0) && ok;
+
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+    ok = testIterationCount() && ok;
+    ok = testPid() && ok;
+    ok = testFailureAware() && ok;
+
+    return ok ? 0 : 1;
+}